@@ -0,0 +1,460 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* Line length distributions, sampled by alias method.
+ * Each distribution gives weight to line lengths in
+ * [minimum, maximum], then weights are turned into alias table.
+ * Continuous distributions are truncated to [minimum, maximum].
+ */
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "linedist.h"
+
+#if (!defined(__maybe_unused))
+#if defined(__GNUC__)
+#define __maybe_unused __attribute__((unused))
+#else
+#define __maybe_unused
+#endif /* defined(__GNUC__) */
+#endif /* (!defined(__maybe_unused)) */
+
+/* Error output file pointer, owned by main program. */
+extern FILE	*fpError;
+
+/*! The maximum number of parameters. */
+#define	LINEDIST_PARAMS		(2)
+
+/*! Distribution definition. */
+typedef struct {
+	const char	*Name;
+	int		Params;		/*!< The number of parameters. */
+	const char	*Usage;
+	const char	*Description;
+	/*! Weight of line length k. */
+	double		(*Weight)(const double *param, ssize_t min, ssize_t k);
+	/*! Check parameters. */
+	bool		(*Check)(const double *param);
+} LineDistDef;
+
+static double NormalWeight(const double *param, __maybe_unused ssize_t min, ssize_t k)
+{	double		z;
+
+	z = ((double)k - param[0]) / param[1];
+	return exp(-0.5 * z * z);
+}
+
+static bool NormalCheck(const double *param)
+{	return param[1] > 0.0;
+}
+
+static double ExpWeight(const double *param, ssize_t min, ssize_t k)
+{	return exp(-(double)(k - min) / param[0]);
+}
+
+static bool ExpCheck(const double *param)
+{	return param[0] > 0.0;
+}
+
+static double GeometricWeight(const double *param, ssize_t min, ssize_t k)
+{	if (param[0] >= 1.0) {
+		return (k == min) ? 1.0 : 0.0;
+	}
+	return exp((double)(k - min) * log1p(-param[0]));
+}
+
+static bool GeometricCheck(const double *param)
+{	return (param[0] > 0.0) && (param[0] <= 1.0);
+}
+
+static double ZipfWeight(const double *param, ssize_t min, ssize_t k)
+{	return pow((double)(k - min + 1), -param[0]);
+}
+
+static bool ZipfCheck(const double *param)
+{	return param[0] > 0.0;
+}
+
+static const LineDistDef LineDistDefs[] = {
+	{	.Name = "uniform",
+		.Params = 0,
+		.Usage = "uniform",
+		.Description = "Uniform in [minimum, maximum] (default).",
+	},
+	{	.Name = "normal",
+		.Params = 2,
+		.Usage = "normal:mean,sd",
+		.Description = "Normal, truncated to [minimum, maximum].",
+		.Weight = NormalWeight,
+		.Check = NormalCheck,
+	},
+	{	.Name = "exp",
+		.Params = 1,
+		.Usage = "exp:mean",
+		.Description = "Exponential of (length - minimum), truncated to maximum.",
+		.Weight = ExpWeight,
+		.Check = ExpCheck,
+	},
+	{	.Name = "geometric",
+		.Params = 1,
+		.Usage = "geometric:p",
+		.Description = "Geometric of (length - minimum), 0 < p <= 1, truncated to maximum.",
+		.Weight = GeometricWeight,
+		.Check = GeometricCheck,
+	},
+	{	.Name = "zipf",
+		.Params = 1,
+		.Usage = "zipf:s",
+		.Description = "Zipf, weight (length - minimum + 1)^-s, s > 0.",
+		.Weight = ZipfWeight,
+		.Check = ZipfCheck,
+	},
+	{	.Name = "hist",
+		.Params = 0,
+		.Usage = "hist:path",
+		.Description = "Histogram file, \"length [weight]\" per line, ignores minimum and maximum.",
+	},
+};
+
+#define	LINEDIST_DEFS	(sizeof(LineDistDefs) / sizeof(LineDistDefs[0]))
+
+void LineDistHelp(const char *a0)
+{	size_t		i;
+
+	for (i = 0; i < LINEDIST_DEFS; i++) {
+		fprintf(fpError, "%s: HELP:   %s: %s\n",
+			a0, LineDistDefs[i].Usage, LineDistDefs[i].Description
+		);
+	}
+}
+
+/*! Build alias table from weights.
+ *  @param ld points table, Min and Count are set.
+ *  @param w weights of Count line lengths, destroyed.
+ *  @return bool true: success, false: error.
+ */
+static bool LineDistBuild(LineDist *ld, double *w, const char *a0)
+{	uint32_t	n;
+	uint32_t	*work;
+	uint32_t	small;	/* small indexes from work[0] upward */
+	uint32_t	large;	/* large indexes from work[n - 1] downward */
+	uint32_t	s;
+	uint32_t	l;
+	uint32_t	i;
+	double		sum = 0.0;
+
+	n = ld->Count;
+	for (i = 0; i < n; i++) {
+		sum += w[i];
+	}
+	if ((!(sum > 0.0)) || (!isfinite(sum))) {
+		fprintf(fpError, "%s: ERROR: Distribution has no weight in line length range. distribution=%s\n",
+			a0, ld->Name
+		);
+		return false;
+	}
+	ld->Prob = malloc(sizeof(*(ld->Prob)) * n);
+	ld->Alias = malloc(sizeof(*(ld->Alias)) * n);
+	work = malloc(sizeof(*work) * n);
+	if ((!(ld->Prob)) || (!(ld->Alias)) || (!work)) {
+		fprintf(fpError, "%s: ERROR: Can not allocate distribution table. n=%lu\n",
+			a0, (unsigned long)n
+		);
+		free(work);
+		return false;
+	}
+
+	small = 0;
+	large = n;
+	for (i = 0; i < n; i++) {
+		w[i] = w[i] * n / sum;
+		if (w[i] < 1.0) {
+			work[small] = i;
+			small++;
+		} else {
+			large--;
+			work[large] = i;
+		}
+	}
+	while ((small > 0) && (large < n)) {
+		small--;
+		s = work[small];
+		l = work[large];
+		ld->Prob[s] = (uint64_t)(w[s] * 4294967296.0);
+		ld->Alias[s] = l;
+		w[l] = (w[l] + w[s]) - 1.0;
+		if (w[l] < 1.0) {
+			/* Move l from large to small. */
+			large++;
+			work[small] = l;
+			small++;
+		}
+	}
+	/* Left ones are 1.0 except rounding error. */
+	while (small > 0) {
+		small--;
+		s = work[small];
+		ld->Prob[s] = 1ULL << 32;
+		ld->Alias[s] = s;
+	}
+	while (large < n) {
+		l = work[large];
+		ld->Prob[l] = 1ULL << 32;
+		ld->Alias[l] = l;
+		large++;
+	}
+	free(work);
+	return true;
+}
+
+/*! Allocate weights of Count line lengths.
+ *  @return double * weights, NULL: error.
+ */
+static double *LineDistWeights(LineDist *ld, ssize_t min, ssize_t max,
+	const char *a0)
+{	double		*w;
+
+	if ((max < min) || ((max - min) >= LINEDIST_COUNT_MAX)) {
+		fprintf(fpError, "%s: ERROR: Too wide line length range for distribution. min=%ld, max=%ld, limit=%ld\n",
+			a0, (long)min, (long)max, (long)LINEDIST_COUNT_MAX
+		);
+		return NULL;
+	}
+	ld->Min = min;
+	ld->Count = (uint32_t)(max - min + 1);
+	w = calloc(ld->Count, sizeof(*w));
+	if (!w) {
+		fprintf(fpError, "%s: ERROR: Can not allocate distribution weights. n=%lu\n",
+			a0, (unsigned long)(ld->Count)
+		);
+	}
+	return w;
+}
+
+/*! Load histogram file, "length [weight]" per line.
+ *  Empty lines and lines start with '#' are skipped.
+ *  Weight is 1 if omitted, the same length accumulates weight.
+ *  @return bool true: success, false: error.
+ */
+static bool LineDistHist(LineDist *ld, const char *path, const char *a0)
+{	FILE		*fp;
+	char		*line = NULL;
+	size_t		line_size = 0;
+	long		*len = NULL;
+	double		*weight = NULL;
+	size_t		n = 0;
+	size_t		size = 0;
+	size_t		i;
+	long		lnum = 0;
+	long		hmin = 0;
+	long		hmax = 0;
+	char		*p;
+	char		*p2;
+	double		*w;
+	bool		result = false;
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		fprintf(fpError, "%s: ERROR: Can not open histogram, %s. path=\"%s\"\n",
+			a0, strerror(errno), path
+		);
+		return false;
+	}
+	while (getline(&line, &line_size, fp) >= 0) {
+		long	l;
+		double	v = 1.0;
+
+		lnum++;
+		p = line;
+		while ((*p == ' ') || (*p == '\t')) {
+			p++;
+		}
+		if ((*p == '#') || (*p == '\n') || (*p == '\r') || (*p == 0)) {
+			continue;
+		}
+		l = strtol(p, &p2, 10);
+		if ((p2 == p) || (l < 0)) {
+			fprintf(fpError, "%s: ERROR: Specify non negative line length. path=\"%s\", line=%ld\n",
+				a0, path, lnum
+			);
+			goto out;
+		}
+		p = p2;
+		v = strtod(p, &p2);
+		if (p2 == p) {
+			v = 1.0;
+		}
+		if ((!(v >= 0.0)) || (!isfinite(v))) {
+			fprintf(fpError, "%s: ERROR: Specify non negative weight. path=\"%s\", line=%ld\n",
+				a0, path, lnum
+			);
+			goto out;
+		}
+		p = p2;
+		while ((*p == ' ') || (*p == '\t')) {
+			p++;
+		}
+		if ((*p != '#') && (*p != '\n') && (*p != '\r') && (*p != 0)) {
+			fprintf(fpError, "%s: ERROR: Garbage after weight. path=\"%s\", line=%ld\n",
+				a0, path, lnum
+			);
+			goto out;
+		}
+		if (n >= size) {
+			long	*len_new;
+			double	*weight_new;
+
+			size = (size ? size * 2 : 256);
+			len_new = realloc(len, sizeof(*len) * size);
+			if (len_new) {
+				len = len_new;
+			}
+			weight_new = realloc(weight, sizeof(*weight) * size);
+			if (weight_new) {
+				weight = weight_new;
+			}
+			if ((!len_new) || (!weight_new)) {
+				fprintf(fpError, "%s: ERROR: Can not allocate histogram. n=%lu\n",
+					a0, (unsigned long)size
+				);
+				goto out;
+			}
+		}
+		if ((n == 0) || (l < hmin)) {
+			hmin = l;
+		}
+		if ((n == 0) || (l > hmax)) {
+			hmax = l;
+		}
+		len[n] = l;
+		weight[n] = v;
+		n++;
+	}
+	if (n == 0) {
+		fprintf(fpError, "%s: ERROR: Histogram has no line length. path=\"%s\"\n",
+			a0, path
+		);
+		goto out;
+	}
+	w = LineDistWeights(ld, hmin, hmax, a0);
+	if (!w) {
+		goto out;
+	}
+	for (i = 0; i < n; i++) {
+		w[len[i] - hmin] += weight[i];
+	}
+	result = LineDistBuild(ld, w, a0);
+	free(w);
+out:
+	free(line);
+	free(len);
+	free(weight);
+	fclose(fp);
+	return result;
+}
+
+/*! Build distribution table.
+ *  @param ld points table to build.
+ *  @param spec distribution "name[:parameters]", NULL means uniform.
+ *  @param min minimum line length.
+ *  @param max maximum line length.
+ *  @param a0 program name for messages.
+ *  @return bool true: success, false: error.
+ */
+bool LineDistInit(LineDist *ld, const char *spec, ssize_t min, ssize_t max,
+	const char *a0)
+{	const LineDistDef	*def = NULL;
+	double		param[LINEDIST_PARAMS] = {0.0, 0.0};
+	size_t		name_len;
+	const char	*p;
+	char		*p2;
+	double		*w;
+	ssize_t		k;
+	size_t		i;
+	int		j;
+	bool		result;
+
+	ld->Name = LineDistDefs[0].Name;
+	ld->Min = min;
+	ld->Count = 0;
+	ld->Prob = NULL;
+	ld->Alias = NULL;
+	if (!spec) {
+		return true;
+	}
+
+	p = strchr(spec, ':');
+	name_len = (p ? (size_t)(p - spec) : strlen(spec));
+	for (i = 0; i < LINEDIST_DEFS; i++) {
+		if ((strlen(LineDistDefs[i].Name) == name_len) &&
+		    (strncmp(LineDistDefs[i].Name, spec, name_len) == 0)) {
+			def = &(LineDistDefs[i]);
+			break;
+		}
+	}
+	if (!def) {
+		fprintf(fpError, "%s: ERROR: Unknown distribution. distribution=\"%s\"\n",
+			a0, spec
+		);
+		return false;
+	}
+	ld->Name = def->Name;
+
+	if (strcmp(def->Name, "hist") == 0) {
+		if ((!p) || (*(p + 1) == 0)) {
+			fprintf(fpError, "%s: ERROR: Specify histogram file path. usage=%s\n",
+				a0, def->Usage
+			);
+			return false;
+		}
+		return LineDistHist(ld, p + 1, a0);
+	}
+
+	for (j = 0; j < def->Params; j++) {
+		const char	*q;
+
+		if ((!p) || (*p != ((j == 0) ? ':' : ','))) {
+			break;
+		}
+		q = p + 1;
+		param[j] = strtod(q, &p2);
+		if (p2 == q) {
+			break;
+		}
+		p = p2;
+	}
+	if ((j < def->Params) || ((p) && (*p != 0)) ||
+	    ((def->Check) && (!(def->Check(param))))) {
+		fprintf(fpError, "%s: ERROR: Invalid distribution parameter(s). distribution=\"%s\", usage=%s\n",
+			a0, spec, def->Usage
+		);
+		return false;
+	}
+	if (!(def->Weight)) {
+		/* uniform */
+		return true;
+	}
+
+	w = LineDistWeights(ld, min, max, a0);
+	if (!w) {
+		return false;
+	}
+	for (k = min; k <= max; k++) {
+		w[k - min] = def->Weight(param, min, k);
+	}
+	result = LineDistBuild(ld, w, a0);
+	free(w);
+	return result;
+}
+
+void LineDistFree(LineDist *ld)
+{	free(ld->Prob);
+	ld->Prob = NULL;
+	free(ld->Alias);
+	ld->Alias = NULL;
+	ld->Count = 0;
+}
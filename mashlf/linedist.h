@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* Line length distributions, sampled by alias method
+ * (A. J. Walker 1977, M. D. Vose 1991).
+ * Table is built once, then a line length is drawn by one 64 bits
+ * random number in constant time.
+ */
+#if (!defined(LINEDIST_H))
+#define LINEDIST_H
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*! The maximum number of line lengths in a table. */
+#define	LINEDIST_COUNT_MAX	(1 << 22)
+
+/*! Line length distribution. */
+typedef struct {
+	const char	*Name;	/*!< Distribution name. */
+	ssize_t		Min;	/*!< Line length of index 0. */
+	uint32_t	Count;	/*!< The number of line lengths, 0: uniform. */
+	uint64_t	*Prob;	/*!< Keep index if low 32 bits < Prob[], scaled by 2^32. */
+	uint32_t	*Alias;	/*!< Index used instead. */
+} LineDist;
+
+/* builds table from "name[:parameters]", see LineDistHelp() */
+bool LineDistInit(LineDist *ld, const char *spec, ssize_t min, ssize_t max,
+	const char *a0);
+
+/* frees table */
+void LineDistFree(LineDist *ld);
+
+/* prints distribution list in help message format */
+void LineDistHelp(const char *a0);
+
+/*! Line length distribution is uniform, not table. */
+static inline bool LineDistIsUniform(const LineDist *ld)
+{	return ld->Count == 0;
+}
+
+/*! Sample line length.
+ *  @param ld points table, not uniform.
+ *  @param u 64 bits random number, high 32 bits select index
+ *         (bias is less than Count / 2^32), low 32 bits select alias.
+ *  @return ssize_t line length.
+ */
+static inline ssize_t LineDistSample(const LineDist *ld, uint64_t u)
+{	uint32_t	i;
+
+	i = (uint32_t)(((u >> 32) * ld->Count) >> 32);
+	if ((u & 0xffffffffULL) >= ld->Prob[i]) {
+		i = ld->Alias[i];
+	}
+	return ld->Min + i;
+}
+
+#endif /* (!defined(LINEDIST_H)) */
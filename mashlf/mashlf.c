@@ -17,9 +17,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+#define	MASHLF_X86
+#include <immintrin.h>
+#endif
 #include "../mt19937ar/mt19937ar.h"
+#include "../mt19937ar/prng-engine.h"
 #define GETOPT_ALT_TAKEOVER
 #include "../getopt/getopt-alt.h"
+#include "utf8seq.h"
+#include "linedist.h"
 
 #define	__force_cast
 
@@ -43,32 +51,48 @@ FILE	*fpError = NULL;
 
 const char HelpMessage[] =
 /* 1 */	"%s: HELP: Add randomly LF to text stream stdin to stdout.\n"
-/* 2 */	"%s: HELP: mashlf [-v] [-s seed_value] [-i minimum] [-a maximum] [-d distribution]\n"
+/* 2 */	"%s: HELP: mashlf [-v] [-s seed_value] [-e engine] [-b] [-i minimum] [-a maximum] [-d distribution] [-j threads]\n"
 /* 3 */	"%s: HELP: -v: Debug\n"
 /* 4 */	"%s: HELP: -V: Debug switch, e=message to stdout.\n"
 /* 5 */	"%s: HELP: -s seed_value: Integer pseudo random seed value\n"
 /* 6 */	"%s: HELP: -i minimum_length: Minimum line length\n"
 /* 7 */	"%s: HELP: -a maximum_length: Maximum line length\n"
-/* 8 */	"%s: HELP: -d distribution: Distribution function (not implemented)\n"
+/* 8 */	"%s: HELP: -b: Draw line length by integer bounded sampling (unbiased, no floating point),\n"
+/* 9 */	"%s: HELP:     line breaks differ from default (floating point scaling), uniform only.\n"
+/* 10 */	"%s: HELP: -j threads: Process input by threads, output is the same as single thread.\n"
+/* 11 */	"%s: HELP: -e engine: Pseudo random number generator engine, one of followings.\n"
+	;
+
+const char HelpMessageDistribution[] =
+	"%s: HELP: -d distribution: Line length distribution, one of followings.\n"
 	;
 
+/*! The maximum number of threads, -j option. */
+#define	MASHLF_THREADS_MAX	(256)
+
 typedef struct {
 	bool		Debug;
 	bool		Help;
 	char		*Argv0;
 	unsigned long	Seed;
+	const PrngEngineOps	*Engine;
+	bool		Bounded;
 	ssize_t		MinimumLength;
 	ssize_t		MaximumLength;
 	char		*Distribution;
+	long		Threads;
 } CCommandLine;
 
 CCommandLine	CommandLine = {
 	.Debug =	false,
 	.Help =		false,
 	.Seed = 0,
+	.Engine = NULL,
+	.Bounded = false,
 	.MinimumLength = 0,
 	.MaximumLength = 8191,
 	.Distribution = NULL,
+	.Threads = 1,
 };
 
 bool CCommandLineParse(CCommandLine *cmdl, int argc, char **argv)
@@ -81,7 +105,8 @@ bool CCommandLineParse(CCommandLine *cmdl, int argc, char **argv)
 	char	*p2;
 
 	cmdl->Argv0 = argv[0];
-	while ((opt = getopt(argc, argv, "s:i:a:d:vV:h")) != -1) {
+	cmdl->Engine = PrngEngineFind(NULL);
+	while ((opt = getopt(argc, argv, "s:e:bi:a:d:j:vV:h")) != -1) {
 		switch (opt) {
 		case 's':
 			/* Set Random Seed */
@@ -141,6 +166,34 @@ bool CCommandLineParse(CCommandLine *cmdl, int argc, char **argv)
 			/* Set Distribution. */
 			cmdl->Distribution = optarg;
 			break;
+		case 'j':
+			/* Set threads */
+			p = optarg;
+			p2 = p;
+			lval = strtol(p, &p2, 0);
+			if ((p2 == p) || (*p2 != 0) || (lval < 1) || (lval > MASHLF_THREADS_MAX)) {
+				fprintf(fpError, "%s: ERROR: Specify 1 to %d to -j (threads) option.\n",
+					cmdl->Argv0, MASHLF_THREADS_MAX
+				);
+				result = false;
+			} else {
+				cmdl->Threads = lval;
+			}
+			break;
+		case 'b':
+			/* Set bounded sampling. */
+			cmdl->Bounded = true;
+			break;
+		case 'e':
+			/* Set engine. */
+			cmdl->Engine = PrngEngineFind(optarg);
+			if (!(cmdl->Engine)) {
+				fprintf(fpError, "%s: ERROR: Unknown engine. engine=\"%s\"\n",
+					cmdl->Argv0, optarg
+				);
+				result = false;
+			}
+			break;
 		case 'v':
 			/* Set debug */
 			cmdl->Debug = true;
@@ -179,6 +232,14 @@ bool CCommandLineParse(CCommandLine *cmdl, int argc, char **argv)
 		cmdl->MaximumLength = tmp;
 	}
 
+	if ((cmdl->Bounded) && (cmdl->Distribution) &&
+	    (strcmp(cmdl->Distribution, "uniform") != 0)) {
+		fprintf(fpError, "%s: ERROR: Can not use -b (bounded sampling) with non uniform distribution. distribution=\"%s\"\n",
+			cmdl->Argv0, cmdl->Distribution
+		);
+		result = false;
+	}
+
 	if (optind < argc) {
 		fprintf(fpError, "%s: ERROR: There are no ordered argument(s).\n",
 			cmdl->Argv0
@@ -191,298 +252,346 @@ bool CCommandLineParse(CCommandLine *cmdl, int argc, char **argv)
 }
 
 
-#define UTF8SEQ_INIT	(0x00)
-#define UTF8SEQ_ASC	(0x01)
-/*! @note UTF8SEQ_R2, _R3, _R4 should be the number of encoded bytes. */
-#define UTF8SEQ_R2	(0x02)
-#define UTF8SEQ_R3	(0x03)
-#define UTF8SEQ_R4	(0x04)
-#define UTF8SEQ_FIELD	(0x08)
+/*! Count leading ASCII bytes except LF, scalar.
+ *  @return size_t the number of bytes in [0x00, 0x7f] and not LF.
+ */
+static size_t AsciiRunScalar(const uint8_t *buf, size_t n)
+{	size_t	i;
 
-typedef struct {
-	uint8_t		SeqRange;
-	uint8_t		SeqField;
-	uint8_t		PendingChar;
-	ssize_t		CodeCount;
-	ssize_t		CodeRawCount;
-	uint8_t		CodeRaw[5];
-} UTF8Sequencer;
-
-void UTF8SequencerInit(UTF8Sequencer *us)
-{	us->SeqRange = UTF8SEQ_INIT;
-	us->SeqField = 0;
-	us->PendingChar = 0x00;
-	us->CodeCount = 0;
-	us->CodeRawCount = 0;
-	memset(&(us->CodeRaw[0]), 0, sizeof(us->CodeRaw));
+	for (i = 0; i < n; i++) {
+		if ((buf[i] & 0x80) || (buf[i] == '\n')) {
+			break;
+		}
+	}
+	return i;
 }
 
-uint8_t UTF8SeqDetChar(uint8_t c)
-{	uint8_t		t;
-
-	if (c <= 0x7f) {
-		/* 00000000 .. 01111111 */
-		return UTF8SEQ_ASC;
-	}
-
-	t = c & 0xc0;
-	if (t == 0xc0) {
-		/* 11xxxxxx */
-		t = c & 0xe0;
-		if (t == 0xc0) {
-			/* 110xxxxx */
-			return UTF8SEQ_R2;
-		} else {
-			t = c & 0xf0;
-			if (t == 0xe0) {
-				/* 1110xxxx */
-				return UTF8SEQ_R3;
-			}
-			/* 1111xxxx */
-			return UTF8SEQ_R4;
+#if (defined(MASHLF_X86))
+#if (defined(__SSE2__))
+/*! Count leading ASCII bytes except LF, SSE2, 16 bytes a step. */
+static size_t AsciiRunSse2(const uint8_t *buf, size_t n)
+{	const __m128i	lf = _mm_set1_epi8('\n');
+	__m128i		v;
+	unsigned int	mask;
+	size_t		i = 0;
+
+	while (i + 16 <= n) {
+		v = _mm_loadu_si128((const __m128i *)(buf + i));
+		mask = (unsigned int)_mm_movemask_epi8(
+			_mm_or_si128(v, _mm_cmpeq_epi8(v, lf))
+		);
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
 		}
-	} else {
-		/* 10xxxxxx */
-		return UTF8SEQ_FIELD;
+		i += 16;
 	}
-	return UTF8SEQ_ASC;
+	return i + AsciiRunScalar(buf + i, n - i);
+}
+#endif /* (defined(__SSE2__)) */
+
+/*! Count leading ASCII bytes except LF, AVX2, 32 bytes a step. */
+__attribute__((target("avx2")))
+static size_t AsciiRunAvx2(const uint8_t *buf, size_t n)
+{	const __m256i	lf = _mm256_set1_epi8('\n');
+	__m256i		v;
+	unsigned int	mask;
+	size_t		i = 0;
+
+	while (i + 32 <= n) {
+		v = _mm256_loadu_si256((const __m256i *)(buf + i));
+		/* High bit of byte set: non ASCII or LF. */
+		mask = (unsigned int)_mm256_movemask_epi8(
+			_mm256_or_si256(v, _mm256_cmpeq_epi8(v, lf))
+		);
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
+		}
+		i += 32;
+	}
+	return i + AsciiRunScalar(buf + i, n - i);
 }
 
-#define	UTF8SEQ_CHAR_NOP	(0xffff)
-#define	UTF8SEQ_CHAR_KNOCK	(0xfffe)
-
-/* @note We can repeat calling UTF8SequencerStepTock() twice or more.
- */
-void UTF8SequencerStepTock(UTF8Sequencer *us)
-{	uint8_t		r;
-	uint8_t		f;
-
-	r = us->SeqRange;
-	f = us->SeqField;
-	/* Adjust Sequence State */
-	switch (r) {
-	case UTF8SEQ_INIT:
-	case UTF8SEQ_ASC:
-		us->SeqField = 0;
-		us->PendingChar = 0x00;
-		us->CodeCount = 0;
-		us->CodeRawCount = 0;
-		break;
-	case UTF8SEQ_R2: /* A.Rx.R2 */
-	case UTF8SEQ_R3: /* A.Rx.R3 */
-	case UTF8SEQ_R4: /* A.Rx.R4 */
-		if ((f + 1) >= r) {
-			/* Got all encoded bytes. */
-			us->SeqRange = UTF8SEQ_INIT;
-			us->SeqField = 0;
-			us->PendingChar = 0x00;
-			us->CodeCount = 0;
-			us->CodeRawCount = 0;
-			break;
+/*! Count leading ASCII bytes except LF, AVX-512BW, 64 bytes a step. */
+__attribute__((target("avx512f,avx512bw")))
+static size_t AsciiRunAvx512(const uint8_t *buf, size_t n)
+{	const __m512i	lf = _mm512_set1_epi8('\n');
+	const __m512i	hi = _mm512_set1_epi8((char)0x80);
+	__m512i		v;
+	uint64_t	mask;
+	size_t		i = 0;
+
+	while (i + 64 <= n) {
+		v = _mm512_loadu_si512((const void *)(buf + i));
+		mask = _mm512_test_epi8_mask(v, hi) | _mm512_cmpeq_epi8_mask(v, lf);
+		if (mask != 0) {
+			return i + __builtin_ctzll(mask);
 		}
-		/* @note If come here, We are on one of
-		 * following state.
-		 *  1. Waiting succeeding encoded byte(s).
-		 *  2. PendingChar may have character to place
-		 *     CodeRaw[].
-		 */
-		break;
-	case UTF8SEQ_FIELD: /* A.F */
-		us->SeqRange = UTF8SEQ_INIT;
-		us->SeqField = 0;
-		us->PendingChar = 0x00;
-		us->CodeCount = 0;
-		us->CodeRawCount = 0;
-		break;
-	default: /* Will not come here. */
-		/* Do nothing */
-		break;
+		i += 64;
 	}
+	return i + AsciiRunScalar(buf + i, n - i);
 }
+#endif /* (defined(MASHLF_X86)) */
 
-ssize_t UTF8SequencerStepTick(UTF8Sequencer *us, uint16_t cc)
-{	uint8_t		pend;
-	uint8_t		r;
-	uint8_t		f;
-	uint8_t		det;
-	ssize_t		rcount;
-
-	r = us->SeqRange;
-	f = us->SeqField;
-
-	/* If there is pending char, buffer it to CodeRaw[]. */
-	pend = us->PendingChar;
-	if (pend != 0x00) {
-		/* There is pending character. */
-		/* @note: pending char range is [0x80 .. 0xff]. */
-		us->CodeRawCount = 1;
-		us->CodeRaw[0] = pend; /* P.To0 */
-		us->PendingChar = 0x00;
-	}
-
-	if (cc > ((uint8_t)~0x00)) {
-		/* Knocked, will flush bytes from CodeRaw[]. */
-		return us->CodeRawCount;
-	}
-
-	det = UTF8SeqDetChar((__force_cast uint8_t)cc);
-	switch (r) {
-	case UTF8SEQ_INIT:
-	case UTF8SEQ_ASC: /* R.ASC */
-		switch (det) {
-		case UTF8SEQ_ASC:
-			us->SeqRange = det;
-			us->SeqField = 0;
-			us->CodeCount = 1;
-			us->CodeRawCount = 1;
-			us->CodeRaw[0] = (__force_cast uint8_t)cc;
-			return 1;
-		case UTF8SEQ_R2:
-		case UTF8SEQ_R3:
-		case UTF8SEQ_R4:
-			us->SeqRange = det;
-			us->SeqField = 0;
-			us->CodeCount = 0;
-			us->CodeRawCount = 1;
-			us->CodeRaw[0] = (__force_cast uint8_t)cc;
-			return 0;
-		case UTF8SEQ_FIELD:
-			us->SeqRange = det;
-			us->SeqField = 0;
-			us->CodeCount = 1;
-			us->CodeRawCount = 1;
-			us->CodeRaw[0] = (__force_cast uint8_t)cc;
-			/* Will be adjusted at A.F */
-			return 1;
-		default: /* Will not come here. */
-			us->SeqRange = UTF8SEQ_ASC;
-			us->SeqField = 0;
-			us->CodeCount = 0;
-			us->CodeRawCount = 1;
-			us->CodeRaw[0] = (__force_cast uint8_t)cc;
-			return 1;
-		}
-	case UTF8SEQ_R2:
-	case UTF8SEQ_R3:
-	case UTF8SEQ_R4:
-		switch (det) {
-		case UTF8SEQ_FIELD:
-			f++;
-			/* Will be adjusted at Tock()
-			 * {A.Rx.R2, A.Rx.R3, A.Rx.R4}
-			 */
-			us->SeqField = f;
-			rcount = us->CodeRawCount;
-			us->CodeRaw[rcount] = (__force_cast uint8_t)cc;
-			rcount++;
-			us->CodeRawCount = rcount;
-			if ((f + 1) >= r) {
-				/* Got all encoded bytes. */
-				us->CodeCount = 1;
-				return rcount;
-			}
-			return 0;
-		case UTF8SEQ_ASC:
-			us->SeqRange = det;
-			us->SeqField = 0;
-			us->CodeCount = 2; /* Broken Rx and ASCII */
-			rcount = us->CodeRawCount;
-			us->CodeRaw[rcount] = (__force_cast uint8_t)cc;
-			rcount++;
-			/* Will be adjusted at R.ASC */
-			us->CodeRawCount = rcount;
-			return rcount;
-		case UTF8SEQ_R2:
-		case UTF8SEQ_R3:
-		case UTF8SEQ_R4:
-			us->SeqRange = det;
-			us->SeqField = 0;
-			/* Will be poped at P.To0 */
-			us->PendingChar = (__force_cast uint8_t)cc;
-			us->CodeCount = 1; /* Broken Rx */
-			rcount = us->CodeRawCount;
-			return rcount;
-		default: /* Will not come here. */
-			break;
+/*! ASCII run counter, fastest variant on this CPU. */
+static size_t (*AsciiRun)(const uint8_t *buf, size_t n) = AsciiRunScalar;
+
+/*! Select ASCII run counter.
+ *  @note MASHLF_ASCII environment variable (scalar, sse2, avx2, avx512)
+ *        forces variant, for testing.
+ */
+void AsciiRunSelect(void)
+{	const char	*name;
+
+	name = getenv("MASHLF_ASCII");
+	AsciiRun = AsciiRunScalar;
+	if ((name) && (strcmp(name, "scalar") == 0)) {
+		return;
+	}
+#if (defined(MASHLF_X86))
+	if ((!name) || (strcmp(name, "avx512") == 0)) {
+		if (__builtin_cpu_supports("avx512bw")) {
+			AsciiRun = AsciiRunAvx512;
+			return;
+		}
+	}
+	if ((!name) || (strcmp(name, "avx2") == 0)) {
+		if (__builtin_cpu_supports("avx2")) {
+			AsciiRun = AsciiRunAvx2;
+			return;
 		}
-		/* Will not come here. */
-		us->SeqRange = UTF8SEQ_ASC;
-		us->SeqField = 0;
-		us->CodeCount = 2; /* Broken Rx and Broken something. */
-		rcount = us->CodeRawCount;
-		us->CodeRaw[rcount] = (__force_cast uint8_t)cc;
-		rcount++;
-		/* Will be adjusted at R.ASC */
-		us->CodeRawCount = rcount;
-		return rcount;
-	default: /* Will not come here. */
-		break;
-	}
-	/* Will not come here. */
-	us->SeqRange = UTF8SEQ_ASC;
-	us->SeqField = 0;
-	us->CodeCount = 1; /* Broken something. */
-	rcount = us->CodeRawCount;
-	us->CodeRaw[rcount] = (__force_cast uint8_t)cc;
-	rcount++;
-	/* Will be adjusted at R.ASC */
-	us->CodeRawCount = rcount;
-	return rcount;
+	}
+#if (defined(__SSE2__))
+	AsciiRun = AsciiRunSse2;
+#endif /* (defined(__SSE2__)) */
+#endif /* (defined(MASHLF_X86)) */
 }
 
+/*! The number of line lengths drawn at once in bounded mode. */
+#define	MASHLF_CUT_TABLE_LENGTH	(256)
+
+/*! Input block size, read at once. */
+#define	MASHLF_IN_SIZE		(256 * 1024)
+/*! Output buffer size, written at once. */
+#define	MASHLF_OUT_SIZE		(256 * 1024)
+/*! Input chunk size processed by a thread, -j option. */
+#define	MASHLF_CHUNK_SIZE	(4 * 1024 * 1024)
+/*! Process input block by a thread if it is smaller than this. */
+#define	MASHLF_CHUNK_MIN	(64 * 1024)
+
 typedef struct {
+	PrngEngine	Rand;
 	ssize_t		CutMin;
 	double		CutDelta;
+	bool		Bounded;	/*!< Use integer bounded sampling. */
+	uint64_t	CutRange;	/*!< The number of line lengths. */
+	size_t		CutTableIndex;	/*!< Next index of CutTable[]. */
+	uint32_t	CutTable[MASHLF_CUT_TABLE_LENGTH];
+	const LineDist	*Dist;		/*!< Line length table, NULL: uniform. */
+	uint64_t	DistTable[MASHLF_CUT_TABLE_LENGTH]; /*!< Draws for Dist. */
 	ssize_t		CodeCount;
 	ssize_t		CutLength;
+	uint8_t		*OutBuf;	/*!< Output buffer, OutSize bytes. */
+	size_t		OutLen;		/*!< Bytes in OutBuf[]. */
+	size_t		OutSize;	/*!< Size of OutBuf[]. */
+	bool		Collect;	/*!< Grow OutBuf[] instead of writing stdout. */
+	const ssize_t	*Replay;	/*!< Line lengths to use instead of drawing. */
+	size_t		ReplayIndex;	/*!< Next index of Replay[]. */
 } MashLf;
 
-void MashLfInit(MashLf *mlf, ssize_t min, ssize_t max)
-{	mlf->CutMin = min;
+bool MashLfInit(MashLf *mlf, const PrngEngineOps *engine, unsigned long seed,
+	bool bounded, ssize_t min, ssize_t max, const LineDist *dist)
+{	if (!PrngEngineInit(&(mlf->Rand), engine)) {
+		return false;
+	}
+	mlf->OutBuf = malloc(MASHLF_OUT_SIZE);
+	if (!(mlf->OutBuf)) {
+		PrngEngineFree(&(mlf->Rand));
+		return false;
+	}
+	mlf->OutLen = 0;
+	mlf->OutSize = MASHLF_OUT_SIZE;
+	mlf->Collect = false;
+	mlf->Replay = NULL;
+	mlf->ReplayIndex = 0;
+	PrngEngineSeed(&(mlf->Rand), (uint64_t)(seed));
+	mlf->CutMin = min;
 	mlf->CutDelta = max - min + 1;
+	mlf->Bounded = bounded;
+	mlf->CutRange = (uint64_t)(max - min) + 1;
+	mlf->CutTableIndex = MASHLF_CUT_TABLE_LENGTH;
+	mlf->Dist = (LineDistIsUniform(dist) ? NULL : dist);
 	mlf->CodeCount = 0;
 	mlf->CutLength = 0;
+	return true;
 }
 
-void MashLfRandLineChars(MashLf *mlf)
-{	mlf->CutLength = mlf->CutMin + genrand_real2() * mlf->CutDelta;
+void MashLfFree(MashLf *mlf)
+{	free(mlf->OutBuf);
+	mlf->OutBuf = NULL;
+	PrngEngineFree(&(mlf->Rand));
 }
 
-bool MashLfWriteLf(MashLf *mlf)
-{	uint8_t		buf;
-	ssize_t		wlen;
-
-	buf = '\n';
-	wlen = (__force_cast ssize_t)fwrite(&buf, sizeof(buf), 1, stdout);
-	if (wlen < 1) {
-		fprintf(fpError, "stdout: ERROR: Can not write LF, %s.\n",
-			strerror(errno)
+void MashLfRandLineChars(MashLf *mlf)
+{	if (mlf->Replay) {
+		/* Line lengths were drawn in order, see MashLfChunkPlace(). */
+		mlf->CutLength = mlf->Replay[mlf->ReplayIndex];
+		mlf->ReplayIndex++;
+		return;
+	}
+	if (mlf->Dist) {
+		if (mlf->CutTableIndex >= MASHLF_CUT_TABLE_LENGTH) {
+			PrngEngineFillUint64(&(mlf->Rand),
+				mlf->DistTable, MASHLF_CUT_TABLE_LENGTH
+			);
+			mlf->CutTableIndex = 0;
+		}
+		mlf->CutLength = LineDistSample(mlf->Dist,
+			mlf->DistTable[mlf->CutTableIndex]
 		);
-		return false;
+		mlf->CutTableIndex++;
+		return;
 	}
-	mlf->CodeCount = 0;
-	return true;
+	if (!(mlf->Bounded)) {
+		mlf->CutLength = mlf->CutMin + PrngEngineReal2(&(mlf->Rand)) * mlf->CutDelta;
+		return;
+	}
+	if (mlf->CutRange > UINT32_MAX) {
+		mlf->CutLength = mlf->CutMin
+			+ (ssize_t)PrngEngineBounded64(&(mlf->Rand), mlf->CutRange);
+		return;
+	}
+	if (mlf->CutTableIndex >= MASHLF_CUT_TABLE_LENGTH) {
+		/* Draws are consumed in the same order as one by one. */
+		PrngEngineFillBounded32(&(mlf->Rand),
+			mlf->CutTable, MASHLF_CUT_TABLE_LENGTH,
+			(uint32_t)(mlf->CutRange)
+		);
+		mlf->CutTableIndex = 0;
+	}
+	mlf->CutLength = mlf->CutMin + mlf->CutTable[mlf->CutTableIndex];
+	mlf->CutTableIndex++;
 }
 
-bool MashLfWriteThrough(MashLf *mlf, const uint8_t *buf, ssize_t buf_len)
+/*! Write bytes to stdout. */
+bool MashLfWriteStdout(const uint8_t *buf, size_t len)
 {	ssize_t		wlen;
 
-	if (buf_len <= 0) {
+	if (len == 0) {
 		return true;
 	}
-
 	wlen = (__force_cast ssize_t)fwrite(buf,
-		sizeof(*buf),
-		(__force_cast size_t)buf_len, stdout
+		sizeof(*buf), len, stdout
 	);
-	if (wlen < buf_len) {
+	if (wlen < (ssize_t)len) {
 		fprintf(fpError, "stdout: ERROR: Can not write, %s. buf_len=%ld, wlen=%ld\n",
 			strerror(errno),
-			(long)buf_len, (long)wlen
+			(long)len, (long)wlen
 		);
 		return false;
 	}
+	return true;
+}
+
+/*! Write bytes in output buffer to stdout,
+ *  or make room in output buffer to collect.
+ */
+bool MashLfFlush(MashLf *mlf)
+{	size_t		len;
+
+	if (mlf->Collect) {
+		uint8_t		*p;
+
+		p = realloc(mlf->OutBuf, mlf->OutSize * 2);
+		if (!p) {
+			fprintf(fpError, "mashlf: ERROR: Can not allocate output buffer. n=%ld\n",
+				(long)(mlf->OutSize * 2)
+			);
+			return false;
+		}
+		mlf->OutBuf = p;
+		mlf->OutSize *= 2;
+		return true;
+	}
+	len = mlf->OutLen;
+	mlf->OutLen = 0;
+	return MashLfWriteStdout(mlf->OutBuf, len);
+}
+
+bool MashLfWriteLf(MashLf *mlf)
+{	if (mlf->OutLen >= mlf->OutSize) {
+		if (!MashLfFlush(mlf)) {
+			return false;
+		}
+	}
+	mlf->OutBuf[mlf->OutLen] = '\n';
+	mlf->OutLen++;
+	mlf->CodeCount = 0;
+	return true;
+}
+
+bool MashLfWriteThrough(MashLf *mlf, const uint8_t *buf, ssize_t buf_len)
+{
+	if (buf_len <= 0) {
+		return true;
+	}
+	while (mlf->OutLen + buf_len > mlf->OutSize) {
+		if (!MashLfFlush(mlf)) {
+			return false;
+		}
+		if (!(mlf->Collect)) {
+			break;
+		}
+	}
+	/* buf_len is length of an encoded code, fits in buffer. */
+	memcpy(mlf->OutBuf + mlf->OutLen, buf, buf_len);
+	mlf->OutLen += buf_len;
+	return true;
+}
 
+/*! Write run of ASCII codes except LF, insert LF at cut positions.
+ *  Same as propagating each byte from idle sequencer state.
+ *  @param buf points ASCII codes, no LF.
+ *  @param n the number of codes.
+ */
+bool MashLfWriteAscii(MashLf *mlf, const uint8_t *buf, size_t n)
+{	size_t		k;
+	size_t		m;
+	ssize_t		rest;
+
+	while (n > 0) {
+		/* k-th code reaches cut length, at least one. */
+		rest = mlf->CutLength - mlf->CodeCount;
+		k = (rest > 1) ? (size_t)rest : 1;
+		m = (k <= n) ? k : n;
+		while (m > 0) {
+			size_t	chunk = mlf->OutSize - mlf->OutLen;
+
+			if (chunk == 0) {
+				if (!MashLfFlush(mlf)) {
+					return false;
+				}
+				continue;
+			}
+			if (chunk > m) {
+				chunk = m;
+			}
+			memcpy(mlf->OutBuf + mlf->OutLen, buf, chunk);
+			mlf->OutLen += chunk;
+			mlf->CodeCount += chunk;
+			buf += chunk;
+			n -= chunk;
+			k -= chunk;
+			m -= chunk;
+		}
+		if (k > 0) {
+			/* Run ends before cut. */
+			break;
+		}
+		MashLfRandLineChars(mlf);
+		if (!MashLfWriteLf(mlf)) {
+			return false;
+		}
+	}
 	return true;
 }
 
@@ -500,96 +609,477 @@ bool MashLfGrowLine(MashLf *mlf, ssize_t code_count)
 	return result;
 }
 
-bool MashLfPropagate(MashLf *mlf, UTF8Sequencer *us, uint16_t cc)
-{	ssize_t		craw_len;
-	ssize_t		code_count;
-	const uint8_t	*craw;
-
-	if (cc != UTF8SEQ_CHAR_NOP) {
-		/* Update state, will drain bytes in CodeRaw[]
-		 * when encoded byte(s) are(is) completed.
-		 */
-		craw_len = UTF8SequencerStepTick(us, cc);
-		code_count = us->CodeCount;
-	} else {
-		/* Anyway, drain bytes in CodeRaw[] */
-		craw_len = us->CodeRawCount;
-		code_count = 1;
+/*! Propagate sequencer output to output buffer and line length.
+ *  @return bool true: success, false: error.
+ */
+static inline bool MashLfPropagate(MashLf *mlf, const UTF8SeqOut *out)
+{	if (!MashLfWriteThrough(mlf, out->Bytes, out->Len)) {
+		return false;
 	}
+	return MashLfGrowLine(mlf, out->Codes);
+}
 
-	if ((craw_len <= 0) || (code_count <= 0)) {
-		return true;
+
+/*! Process input block, sequencer state continues to next block.
+ *  @return bool true: success, false: error.
+ */
+bool MashLfBlock(MashLf *mlf, UTF8Seq *u8seq, const uint8_t *in, size_t len)
+{	UTF8SeqOut	u8out;
+	size_t		i;
+
+	i = 0;
+	while (i < len) {
+		if (UTF8SeqIsIdle(u8seq)) {
+			/* ASCII fast path, whole run at once. */
+			size_t	run;
+
+			run = AsciiRun(in + i, len - i);
+			if (run > 0) {
+				if (!MashLfWriteAscii(mlf, in + i, run)) {
+					return false;
+				}
+				i += run;
+				continue;
+			}
+		}
+		if (UTF8SeqStep(u8seq, in[i], &u8out)) {
+			if (!MashLfPropagate(mlf, &u8out)) {
+				return false;
+			}
+		}
+		i++;
 	}
+	return true;
+}
 
-	craw = &(us->CodeRaw[0]);
+/* Multi threaded processing (-j option).
+ * Line lengths depend only on drawn numbers and code counts, so
+ * input block is processed in three passes.
+ *  1. Count: Threads count codes of chunks into events.
+ *  2. Place: Walk events in order, draw line lengths as single
+ *     thread does, and hand line lengths to each chunk.
+ *  3. Emit: Threads emit chunks into memory with handed line
+ *     lengths, chunks are written in order.
+ * Each chunk ends just after an ASCII byte, every sequencer state
+ * goes idle by an ASCII byte, so each chunk starts from idle.
+ */
 
-	if (*(craw + craw_len - 1) == '\n') {
-		/* LF terminated,
-		 * block propagating LF to output.
-		 */
-		code_count--;
-		craw_len--;
+/* Events, a run of 1 code events, or a special event below. */
+#define	MASHLF_EVENT_ZERO	(0xffffffffU)	/*!< 0 code (LF) */
+#define	MASHLF_EVENT_TWO	(0xfffffffeU)	/*!< 2 codes (broken and ASCII) */
+#define	MASHLF_EVENT_RUN_MAX	(0xfffffffdU)
+
+/*! Chunk processed by a thread. */
+typedef struct {
+	const uint8_t	*In;		/*!< Chunk in input block. */
+	size_t		Len;		/*!< Bytes in chunk. */
+	uint32_t	*Events;	/*!< Code count events. */
+	size_t		EventCount;
+	size_t		EventSize;
+	ssize_t		*Replay;	/*!< Line lengths drawn in the chunk. */
+	size_t		ReplayCount;
+	size_t		ReplaySize;
+	ssize_t		CodeCount;	/*!< Code count at the beginning. */
+	ssize_t		CutLength;	/*!< Line length at the beginning. */
+	MashLf		Mlf;		/*!< Emits chunk into memory. */
+	bool		Result;
+	pthread_t	Thread;
+} MashLfChunk;
+
+/*! Append element to growing array.
+ *  @return bool true: success, false: can not allocate.
+ */
+static bool MashLfArrayPush(void **array, size_t *count, size_t *size,
+	size_t elem_size, const void *elem)
+{	if (*count >= *size) {
+		size_t	size_new;
+		void	*p;
+
+		size_new = (*size ? *size * 2 : 4096);
+		p = realloc(*array, size_new * elem_size);
+		if (!p) {
+			fprintf(fpError, "mashlf: ERROR: Can not allocate chunk context. n=%ld\n",
+				(long)(size_new * elem_size)
+			);
+			return false;
+		}
+		*array = p;
+		*size = size_new;
 	}
+	memcpy((uint8_t *)(*array) + (*count) * elem_size, elem, elem_size);
+	(*count)++;
+	return true;
+}
 
-	if (!MashLfWriteThrough(mlf, craw, craw_len)) {
-		return false;
+/*! Add event, runs of 1 code are merged. */
+static bool MashLfChunkEvent(MashLfChunk *ch, uint32_t ev)
+{	if ((ev <= MASHLF_EVENT_RUN_MAX) && (ch->EventCount > 0)) {
+		uint32_t	*last = &(ch->Events[ch->EventCount - 1]);
+
+		if ((*last <= MASHLF_EVENT_RUN_MAX) &&
+		    (*last <= MASHLF_EVENT_RUN_MAX - ev)) {
+			*last += ev;
+			return true;
+		}
 	}
+	return MashLfArrayPush((void **)&(ch->Events), &(ch->EventCount),
+		&(ch->EventSize), sizeof(ev), &ev
+	);
+}
 
-	if (!MashLfGrowLine(mlf, code_count)) {
-		return false;
+/*! Count pass, thread entry.
+ *  @param arg points MashLfChunk.
+ */
+static void *MashLfChunkCount(void *arg)
+{	MashLfChunk	*ch = arg;
+	UTF8Seq		u8seq;
+	UTF8SeqOut	u8out;
+	const uint8_t	*in = ch->In;
+	size_t		len = ch->Len;
+	size_t		i;
+	uint32_t	ev;
+
+	ch->EventCount = 0;
+	ch->Result = false;
+	UTF8SeqInit(&u8seq);
+	i = 0;
+	while (i < len) {
+		if (UTF8SeqIsIdle(&u8seq)) {
+			size_t	run;
+
+			run = AsciiRun(in + i, len - i);
+			if (run > 0) {
+				if (!MashLfChunkEvent(ch, (uint32_t)run)) {
+					return NULL;
+				}
+				i += run;
+				continue;
+			}
+		}
+		if (UTF8SeqStep(&u8seq, in[i], &u8out)) {
+			switch (u8out.Codes) {
+			case 0:
+				ev = MASHLF_EVENT_ZERO;
+				break;
+			case 2:
+				ev = MASHLF_EVENT_TWO;
+				break;
+			default:
+				ev = 1;
+				break;
+			}
+			if (!MashLfChunkEvent(ch, ev)) {
+				return NULL;
+			}
+		}
+		i++;
 	}
+	ch->Result = true;
+	return NULL;
+}
 
+/*! Draw next line length, hand it to chunk. */
+static bool MashLfChunkCut(MashLf *mlf, MashLfChunk *ch)
+{	MashLfRandLineChars(mlf);
+	mlf->CodeCount = 0;
+	return MashLfArrayPush((void **)&(ch->Replay), &(ch->ReplayCount),
+		&(ch->ReplaySize), sizeof(ch->Replay[0]), &(mlf->CutLength)
+	);
+}
+
+/*! Place pass, walk events as MashLfGrowLine() and MashLfWriteAscii().
+ *  @param mlf points instance, draws line lengths and holds code count.
+ *  @param ch points chunk counted.
+ *  @return bool true: success, false: error.
+ */
+static bool MashLfChunkPlace(MashLf *mlf, MashLfChunk *ch)
+{	size_t		i;
+	uint32_t	ev;
+	ssize_t		n;
+	ssize_t		rest;
+	ssize_t		k;
+
+	ch->CodeCount = mlf->CodeCount;
+	ch->CutLength = mlf->CutLength;
+	ch->ReplayCount = 0;
+	for (i = 0; i < ch->EventCount; i++) {
+		ev = ch->Events[i];
+		if (ev > MASHLF_EVENT_RUN_MAX) {
+			n = ((ev == MASHLF_EVENT_TWO) ? 2 : 0) + mlf->CodeCount;
+			if (n >= mlf->CutLength) {
+				if (!MashLfChunkCut(mlf, ch)) {
+					return false;
+				}
+			} else {
+				mlf->CodeCount = n;
+			}
+			continue;
+		}
+		n = ev;
+		while (n > 0) {
+			/* k-th code reaches cut length, at least one. */
+			rest = mlf->CutLength - mlf->CodeCount;
+			k = (rest > 1) ? rest : 1;
+			if (k > n) {
+				mlf->CodeCount += n;
+				break;
+			}
+			n -= k;
+			if (!MashLfChunkCut(mlf, ch)) {
+				return false;
+			}
+		}
+	}
 	return true;
 }
 
+/*! Emit pass, thread entry.
+ *  @param arg points MashLfChunk.
+ */
+static void *MashLfChunkEmit(void *arg)
+{	MashLfChunk	*ch = arg;
+	UTF8Seq		u8seq;
+
+	UTF8SeqInit(&u8seq);
+	ch->Mlf.OutLen = 0;
+	ch->Mlf.CodeCount = ch->CodeCount;
+	ch->Mlf.CutLength = ch->CutLength;
+	ch->Mlf.Replay = ch->Replay;
+	ch->Mlf.ReplayIndex = 0;
+	ch->Result = MashLfBlock(&(ch->Mlf), &u8seq, ch->In, ch->Len);
+	if ((ch->Result) && (ch->Mlf.ReplayIndex != ch->ReplayCount)) {
+		fprintf(fpError, "mashlf: ERROR: Internal error, line lengths mismatch. used=%ld, drawn=%ld\n",
+			(long)(ch->Mlf.ReplayIndex), (long)(ch->ReplayCount)
+		);
+		ch->Result = false;
+	}
+	return NULL;
+}
+
+/*! Run pass on chunks by threads, wait them.
+ *  @return bool true: all succeeded, false: error.
+ */
+static bool MashLfChunksRun(MashLfChunk *chunks, long n, void *(*pass)(void *))
+{	long		i;
+	bool		result = true;
+
+	for (i = 0; i < n; i++) {
+		if (pthread_create(&(chunks[i].Thread), NULL, pass, &(chunks[i])) != 0) {
+			/* Run by this thread. */
+			pass(&(chunks[i]));
+			chunks[i].Thread = pthread_self();
+		}
+	}
+	for (i = 0; i < n; i++) {
+		if (!pthread_equal(chunks[i].Thread, pthread_self())) {
+			pthread_join(chunks[i].Thread, NULL);
+		}
+		if (!(chunks[i].Result)) {
+			result = false;
+		}
+	}
+	return result;
+}
+
+/*! Process input block by threads, output is the same as MashLfBlock().
+ *  @param mlf points instance, output and line lengths continue.
+ *  @param u8seq points sequencer, state continues to next block.
+ *  @param chunks points chunk contexts, threads elements.
+ *  @return bool true: success, false: error.
+ */
+bool MashLfBlockThreads(MashLf *mlf, UTF8Seq *u8seq, const uint8_t *in, size_t len,
+	MashLfChunk *chunks, long threads)
+{	size_t		head = 0;
+	size_t		tail;
+	size_t		b;
+	size_t		e;
+	long		n;
+	long		i;
+
+	if (!UTF8SeqIsIdle(u8seq)) {
+		/* Head, until sequencer goes idle by an ASCII byte. */
+		while ((head < len) && (in[head] >= 0x80)) {
+			head++;
+		}
+		if (head < len) {
+			head++;
+		}
+		if (!MashLfBlock(mlf, u8seq, in, head)) {
+			return false;
+		}
+	}
+	/* Tail, after the last ASCII byte. */
+	tail = len;
+	while ((tail > head) && (in[tail - 1] >= 0x80)) {
+		tail--;
+	}
+	if (tail - head < MASHLF_CHUNK_MIN) {
+		return MashLfBlock(mlf, u8seq, in + head, len - head);
+	}
+
+	/* Split into chunks, each ends just after an ASCII byte. */
+	n = 0;
+	b = head;
+	for (i = 0; i < threads; i++) {
+		e = head + (tail - head) / threads * (i + 1);
+		if ((i == threads - 1) || (e > tail)) {
+			e = tail;
+		}
+		if (e <= b) {
+			continue;
+		}
+		while ((e < tail) && (in[e - 1] >= 0x80)) {
+			e++;
+		}
+		chunks[n].In = in + b;
+		chunks[n].Len = e - b;
+		n++;
+		b = e;
+	}
+
+	if (!MashLfChunksRun(chunks, n, MashLfChunkCount)) {
+		return false;
+	}
+	for (i = 0; i < n; i++) {
+		if (!MashLfChunkPlace(mlf, &(chunks[i]))) {
+			return false;
+		}
+	}
+	if (!MashLfChunksRun(chunks, n, MashLfChunkEmit)) {
+		return false;
+	}
+	if (!MashLfFlush(mlf)) {
+		return false;
+	}
+	for (i = 0; i < n; i++) {
+		if (!MashLfWriteStdout(chunks[i].Mlf.OutBuf, chunks[i].Mlf.OutLen)) {
+			return false;
+		}
+	}
+	return MashLfBlock(mlf, u8seq, in + tail, len - tail);
+}
 
 bool MashLfMain(CCommandLine *cmdl)
 {	bool		result = true;
-	UTF8Sequencer	u8seq;
+	UTF8Seq		u8seq;
+	UTF8SeqOut	u8out[2];
+	LineDist	dist;
 	MashLf		mlf;
-	ssize_t		rlen;
-	uint8_t		ch;
-
-	UTF8SequencerInit(&u8seq);
-	init_genrand((uint32_t)(cmdl->Seed));
-	MashLfInit(&mlf, cmdl->MinimumLength, cmdl->MaximumLength);
+	MashLfChunk	*chunks = NULL;
+	long		threads = cmdl->Threads;
+	size_t		in_size = MASHLF_IN_SIZE;
+	size_t		rlen;
+	int		n;
+	int		j;
+	long		i;
+	uint8_t		*in;
+
+	if (threads > 1) {
+		in_size = (size_t)threads * MASHLF_CHUNK_SIZE;
+		chunks = calloc(threads, sizeof(chunks[0]));
+		if (!chunks) {
+			fprintf(fpError, "%s: ERROR: Can not allocate chunk context. threads=%ld\n",
+				cmdl->Argv0, threads
+			);
+			return false;
+		}
+		for (i = 0; i < threads; i++) {
+			chunks[i].Mlf.OutSize = MASHLF_CHUNK_SIZE + MASHLF_CHUNK_SIZE / 8;
+			chunks[i].Mlf.OutBuf = malloc(chunks[i].Mlf.OutSize);
+			chunks[i].Mlf.Collect = true;
+			if (!(chunks[i].Mlf.OutBuf)) {
+				fprintf(fpError, "%s: ERROR: Can not allocate output buffer. n=%ld\n",
+					cmdl->Argv0, (long)(chunks[i].Mlf.OutSize)
+				);
+				result = false;
+				goto out_chunks;
+			}
+		}
+	}
+	in = malloc(in_size);
+	if (!in) {
+		fprintf(fpError, "%s: ERROR: Can not allocate input buffer. n=%ld\n",
+			cmdl->Argv0, (long)in_size
+		);
+		result = false;
+		goto out_chunks;
+	}
+	UTF8SeqInit(&u8seq);
+	if (!LineDistInit(&dist, cmdl->Distribution,
+		cmdl->MinimumLength, cmdl->MaximumLength, cmdl->Argv0)) {
+		LineDistFree(&dist);
+		free(in);
+		result = false;
+		goto out_chunks;
+	}
+	if (!MashLfInit(&mlf, cmdl->Engine, cmdl->Seed, cmdl->Bounded,
+		cmdl->MinimumLength, cmdl->MaximumLength, &dist)) {
+		fprintf(fpError, "%s: ERROR: Can not allocate engine context. engine=%s\n",
+			cmdl->Argv0, cmdl->Engine->Name
+		);
+		LineDistFree(&dist);
+		free(in);
+		result = false;
+		goto out_chunks;
+	}
 
 	MashLfRandLineChars(&mlf);
+	AsciiRunSelect();
 
 	while (!feof(stdin)) {
-		ch = 0;
-		rlen = (__force_cast ssize_t)fread(&ch, sizeof(ch), 1, stdin);
+		rlen = fread(in, sizeof(*in), in_size, stdin);
 		if (rlen == 0) {
 			/* Consider we see end of file
 			 * (no more reads from pipe).
 			 */
 			break;
 		}
-
-		if (!MashLfPropagate(&mlf, &u8seq, ch)) {
-			return false;
+		if (threads > 1) {
+			if (!MashLfBlockThreads(&mlf, &u8seq, in, rlen, chunks, threads)) {
+				result = false;
+				goto out;
+			}
+			continue;
+		}
+		if (!MashLfBlock(&mlf, &u8seq, in, rlen)) {
+			result = false;
+			goto out;
 		}
-
-		UTF8SequencerStepTock(&u8seq);
-	}
-
-	/* Drain bytes in u8seq.CodeRaw[]. */
-	if (!MashLfPropagate(&mlf, &u8seq, UTF8SEQ_CHAR_NOP)) {
-		return false;
 	}
 
-	/* Drain byte in PendingChar */
-	if (!MashLfPropagate(&mlf, &u8seq, UTF8SEQ_CHAR_KNOCK)) {
-		return false;
+	/* Drain broken sequence and pended lead byte. */
+	n = UTF8SeqFinish(&u8seq, u8out);
+	for (j = 0; j < n; j++) {
+		if (!MashLfPropagate(&mlf, &u8out[j])) {
+			result = false;
+			goto out;
+		}
 	}
 
 	if (mlf.CodeCount > 0) {
 		/* Last line isn't LF terminated. */
 		if (!MashLfWriteLf(&mlf)) {
-			return false;
+			result = false;
+			goto out;
 		}
 	}
+	if (!MashLfFlush(&mlf)) {
+		result = false;
+	}
 
+out:
+	MashLfFree(&mlf);
+	LineDistFree(&dist);
+	free(in);
+out_chunks:
+	if (chunks) {
+		for (i = 0; i < threads; i++) {
+			free(chunks[i].Events);
+			free(chunks[i].Replay);
+			free(chunks[i].Mlf.OutBuf);
+		}
+		free(chunks);
+	}
 	return result;
 }
 
@@ -601,11 +1091,14 @@ int main(int argc, char ** argv, char **env)
 
 	parse = CCommandLineParse(&CommandLine, argc, argv);
 	if (CommandLine.Debug) {
-		fprintf(fpError, "%s: DEBUG: Command line. seed=%lu, minimum=%ld, maximum=%ld\n",
+		fprintf(fpError, "%s: DEBUG: Command line. seed=%lu, engine=%s, minimum=%ld, maximum=%ld, distribution=%s, threads=%ld\n",
 			argv[0],
 			(unsigned long)(CommandLine.Seed),
+			(CommandLine.Engine ? CommandLine.Engine->Name : "(unknown)"),
 			(long)(CommandLine.MinimumLength),
-			(long)(CommandLine.MaximumLength)
+			(long)(CommandLine.MaximumLength),
+			(CommandLine.Distribution ? CommandLine.Distribution : "uniform"),
+			CommandLine.Threads
 		);
 	}
 	if ((!parse) || (CommandLine.Help)) {
@@ -614,8 +1107,14 @@ int main(int argc, char ** argv, char **env)
 		argv0 = argv[0];
 		fprintf(fpError, HelpMessage,
 			argv0, argv0, argv0, argv0, argv0,
-			argv0, argv0, argv0
+			argv0, argv0, argv0, argv0, argv0,
+			argv0
+		);
+		PrngEngineHelp(fpError, argv0);
+		fprintf(fpError, HelpMessageDistribution,
+			argv0
 		);
+		LineDistHelp(argv0);
 		return 1;
 	}
 
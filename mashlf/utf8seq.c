@@ -0,0 +1,179 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* UTF-8 sequencer, table driven DFA.
+ *
+ * States
+ *  IDLE        Next byte starts a code.
+ *  Lr_f_c      Got lead byte of r bytes sequence and f continuation
+ *              byte(s), Raw[] holds them. c=1 when the sequence
+ *              started from pended lead byte, counts the code again
+ *              at end of stream. Pr takes the place of Lr_0_1.
+ *  Pr          Lead byte of r bytes sequence broke previous sequence,
+ *              the lead byte is in Pend and Raw[] still holds the
+ *              broken sequence until the next byte comes.
+ *
+ * Broken sequences
+ *  Lr_f_c + ASC    Output broken sequence and ASCII code as 2 codes.
+ *  Lr_f_c + LF     Output broken sequence as 1 code, drop LF.
+ *  Lr_f_c + Rx     Output broken sequence as 1 code, pend lead byte.
+ *  IDLE + FIELD    Output stray continuation byte as 1 code.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "utf8seq.h"
+
+#define	C(b)	(UTF8SEQ_CLASS_ ## b)
+
+/* 16 byte class entries */
+#define	CLASS16(k)	\
+	C(k), C(k), C(k), C(k), C(k), C(k), C(k), C(k), \
+	C(k), C(k), C(k), C(k), C(k), C(k), C(k), C(k)
+
+const uint8_t UTF8SeqClass[256] = {
+	/* 0x00 .. 0x0f */
+	C(ASC), C(ASC), C(ASC), C(ASC), C(ASC), C(ASC), C(ASC), C(ASC),
+	C(ASC), C(ASC), C(LF),  C(ASC), C(ASC), C(ASC), C(ASC), C(ASC),
+	CLASS16(ASC),	/* 0x10 .. 0x1f */
+	CLASS16(ASC),	/* 0x20 .. 0x2f */
+	CLASS16(ASC),	/* 0x30 .. 0x3f */
+	CLASS16(ASC),	/* 0x40 .. 0x4f */
+	CLASS16(ASC),	/* 0x50 .. 0x5f */
+	CLASS16(ASC),	/* 0x60 .. 0x6f */
+	CLASS16(ASC),	/* 0x70 .. 0x7f */
+	CLASS16(FIELD),	/* 0x80 .. 0x8f */
+	CLASS16(FIELD),	/* 0x90 .. 0x9f */
+	CLASS16(FIELD),	/* 0xa0 .. 0xaf */
+	CLASS16(FIELD),	/* 0xb0 .. 0xbf */
+	CLASS16(R2),	/* 0xc0 .. 0xcf */
+	CLASS16(R2),	/* 0xd0 .. 0xdf */
+	CLASS16(R3),	/* 0xe0 .. 0xef */
+	CLASS16(R4),	/* 0xf0 .. 0xff */
+};
+
+/* State numbers */
+#define	IDLE	UTF8SEQ_STATE_IDLE
+#define	L2_0_0	(1)
+#define	L3_0_0	(2)
+#define	L3_1_0	(3)
+#define	L3_1_1	(4)
+#define	L4_0_0	(5)
+#define	L4_1_0	(6)
+#define	L4_1_1	(7)
+#define	L4_2_0	(8)
+#define	L4_2_1	(9)
+#define	P2	(10)
+#define	P3	(11)
+#define	P4	(12)
+
+/* Next state, columns are ASC, LF, FIELD, R2, R3, R4. */
+const uint8_t UTF8SeqNext[UTF8SEQ_STATES][UTF8SEQ_CLASSES] = {
+	[IDLE] =   { IDLE, IDLE, IDLE,   L2_0_0, L3_0_0, L4_0_0 },
+	[L2_0_0] = { IDLE, IDLE, IDLE,   P2, P3, P4 },
+	[L3_0_0] = { IDLE, IDLE, L3_1_0, P2, P3, P4 },
+	[L3_1_0] = { IDLE, IDLE, IDLE,   P2, P3, P4 },
+	[L3_1_1] = { IDLE, IDLE, IDLE,   P2, P3, P4 },
+	[L4_0_0] = { IDLE, IDLE, L4_1_0, P2, P3, P4 },
+	[L4_1_0] = { IDLE, IDLE, L4_2_0, P2, P3, P4 },
+	[L4_1_1] = { IDLE, IDLE, L4_2_1, P2, P3, P4 },
+	[L4_2_0] = { IDLE, IDLE, IDLE,   P2, P3, P4 },
+	[L4_2_1] = { IDLE, IDLE, IDLE,   P2, P3, P4 },
+	/* Pended lead byte goes to Raw[], then acts as Lr_0_0 but counts again. */
+	[P2] =     { IDLE, IDLE, IDLE,   P2, P3, P4 },
+	[P3] =     { IDLE, IDLE, L3_1_1, P2, P3, P4 },
+	[P4] =     { IDLE, IDLE, L4_1_1, P2, P3, P4 },
+};
+
+/* Actions */
+#define	A(codes, bits)	\
+	((uint8_t)(((codes) << UTF8SEQ_ACT_CODES_SHIFT) | (bits)))
+/* Start a code and output it, ASCII code or stray FIELD. */
+#define	A_ONE		A(1, UTF8SEQ_ACT_START | UTF8SEQ_ACT_EMIT | UTF8SEQ_ACT_GROW)
+/* LF, drop it. */
+#define	A_LF		A(0, UTF8SEQ_ACT_GROW)
+/* Lead byte, start sequence. */
+#define	A_LEAD		A(0, UTF8SEQ_ACT_START)
+/* Continuation byte, sequence continues. */
+#define	A_CONT		A(0, UTF8SEQ_ACT_APPEND)
+/* Last continuation byte, output completed code. */
+#define	A_DONE		A(1, UTF8SEQ_ACT_APPEND | UTF8SEQ_ACT_EMIT | UTF8SEQ_ACT_GROW)
+/* Broken sequence and ASCII code. */
+#define	A_BRK_ASC	A(2, UTF8SEQ_ACT_APPEND | UTF8SEQ_ACT_EMIT | UTF8SEQ_ACT_GROW)
+/* Broken sequence and LF. */
+#define	A_BRK_LF	A(1, UTF8SEQ_ACT_EMIT | UTF8SEQ_ACT_GROW)
+/* Broken sequence by lead byte. */
+#define	A_BRK_R		A(1, UTF8SEQ_ACT_EMIT | UTF8SEQ_ACT_PEND | UTF8SEQ_ACT_GROW)
+#define	LD		UTF8SEQ_ACT_LOAD
+
+/* Action, columns are ASC, LF, FIELD, R2, R3, R4. */
+const uint8_t UTF8SeqAction[UTF8SEQ_STATES][UTF8SEQ_CLASSES] = {
+	[IDLE] =   { A_ONE,     A_LF,     A_ONE,  A_LEAD,  A_LEAD,  A_LEAD },
+	[L2_0_0] = { A_BRK_ASC, A_BRK_LF, A_DONE, A_BRK_R, A_BRK_R, A_BRK_R },
+	[L3_0_0] = { A_BRK_ASC, A_BRK_LF, A_CONT, A_BRK_R, A_BRK_R, A_BRK_R },
+	[L3_1_0] = { A_BRK_ASC, A_BRK_LF, A_DONE, A_BRK_R, A_BRK_R, A_BRK_R },
+	[L3_1_1] = { A_BRK_ASC, A_BRK_LF, A_DONE, A_BRK_R, A_BRK_R, A_BRK_R },
+	[L4_0_0] = { A_BRK_ASC, A_BRK_LF, A_CONT, A_BRK_R, A_BRK_R, A_BRK_R },
+	[L4_1_0] = { A_BRK_ASC, A_BRK_LF, A_CONT, A_BRK_R, A_BRK_R, A_BRK_R },
+	[L4_1_1] = { A_BRK_ASC, A_BRK_LF, A_CONT, A_BRK_R, A_BRK_R, A_BRK_R },
+	[L4_2_0] = { A_BRK_ASC, A_BRK_LF, A_DONE, A_BRK_R, A_BRK_R, A_BRK_R },
+	[L4_2_1] = { A_BRK_ASC, A_BRK_LF, A_DONE, A_BRK_R, A_BRK_R, A_BRK_R },
+	[P2] = { LD | A_BRK_ASC, LD | A_BRK_LF, LD | A_DONE,
+		 LD | A_BRK_R,   LD | A_BRK_R,  LD | A_BRK_R },
+	[P3] = { LD | A_BRK_ASC, LD | A_BRK_LF, LD | A_CONT,
+		 LD | A_BRK_R,   LD | A_BRK_R,  LD | A_BRK_R },
+	[P4] = { LD | A_BRK_ASC, LD | A_BRK_LF, LD | A_CONT,
+		 LD | A_BRK_R,   LD | A_BRK_R,  LD | A_BRK_R },
+};
+
+/*! Initialize sequencer. */
+void UTF8SeqInit(UTF8Seq *s)
+{	s->State = UTF8SEQ_STATE_IDLE;
+	s->RawCount = 0;
+	s->Pend = 0x00;
+	s->Raw[0] = 0x00;
+	s->Raw[1] = 0x00;
+	s->Raw[2] = 0x00;
+	s->Raw[3] = 0x00;
+}
+
+/*! Drain sequencer at end of stream.
+ *  Broken sequence in Raw[] is output as a code. Lr_f_1 counts it
+ *  twice, Pr outputs broken sequence then pended lead byte.
+ *  @param s points sequencer.
+ *  @param out points 2 outputs.
+ *  @return int the number of outputs in out[].
+ */
+int UTF8SeqFinish(UTF8Seq *s, UTF8SeqOut out[2])
+{	int		n = 0;
+	uint8_t		state;
+
+	state = s->State;
+	if (state == UTF8SEQ_STATE_IDLE) {
+		return 0;
+	}
+	out[n].Bytes = s->Raw;
+	out[n].Len = s->RawCount;
+	out[n].Codes = 1;
+	n++;
+	switch (state) {
+	case L3_1_1:
+	case L4_1_1:
+	case L4_2_1:
+		out[n] = out[0];
+		n++;
+		break;
+	case P2:
+	case P3:
+	case P4:
+		out[n].Bytes = &(s->Pend);
+		out[n].Len = 1;
+		out[n].Codes = 1;
+		n++;
+		break;
+	default:
+		break;
+	}
+	/* Keep Raw[] and Pend, out[] points them. */
+	s->State = UTF8SEQ_STATE_IDLE;
+	s->RawCount = 0;
+	return n;
+}
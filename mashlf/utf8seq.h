@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* UTF-8 sequencer, table driven DFA.
+ * Splits byte stream into codes, a code is a complete encoded
+ * character or a broken sequence. Each byte is classified by
+ * UTF8SeqClass[], then UTF8SeqNext[] and UTF8SeqAction[] give
+ * next state and what to output.
+ */
+#if (!defined(UTF8SEQ_H))
+#define UTF8SEQ_H
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Byte classes */
+#define	UTF8SEQ_CLASS_ASC	(0)	/*!< 0x00 .. 0x7f except LF */
+#define	UTF8SEQ_CLASS_LF	(1)	/*!< LF */
+#define	UTF8SEQ_CLASS_FIELD	(2)	/*!< 10xxxxxx continuation */
+#define	UTF8SEQ_CLASS_R2	(3)	/*!< 110xxxxx lead of 2 bytes */
+#define	UTF8SEQ_CLASS_R3	(4)	/*!< 1110xxxx lead of 3 bytes */
+#define	UTF8SEQ_CLASS_R4	(5)	/*!< 1111xxxx lead of 4 bytes */
+#define	UTF8SEQ_CLASSES		(6)
+
+/* States, see utf8seq.c for transitions. */
+#define	UTF8SEQ_STATE_IDLE	(0)	/*!< Next byte starts a code. */
+#define	UTF8SEQ_STATES		(13)
+
+/* Action bits, done in this order. */
+#define	UTF8SEQ_ACT_LOAD	(0x01)	/*!< Raw[] = Pend */
+#define	UTF8SEQ_ACT_START	(0x02)	/*!< Raw[] = byte */
+#define	UTF8SEQ_ACT_APPEND	(0x04)	/*!< Raw[] += byte */
+#define	UTF8SEQ_ACT_EMIT	(0x08)	/*!< Output Raw[] */
+#define	UTF8SEQ_ACT_PEND	(0x10)	/*!< Pend = byte, Raw[] is kept */
+#define	UTF8SEQ_ACT_GROW	(0x20)	/*!< Count codes (may be 0) */
+#define	UTF8SEQ_ACT_CODES_SHIFT	(6)	/*!< Codes to count in bits 7..6 */
+
+/*! Sequencer state. */
+typedef struct {
+	uint8_t		State;
+	uint8_t		RawCount;	/*!< Bytes in Raw[]. */
+	uint8_t		Pend;		/*!< Lead byte broke previous sequence. */
+	uint8_t		Raw[4];		/*!< Bytes of current code. */
+} UTF8Seq;
+
+/*! Output of a step, write Bytes[Len] then count Codes codes. */
+typedef struct {
+	const uint8_t	*Bytes;
+	uint8_t		Len;
+	uint8_t		Codes;
+} UTF8SeqOut;
+
+extern const uint8_t UTF8SeqClass[256];
+extern const uint8_t UTF8SeqNext[UTF8SEQ_STATES][UTF8SEQ_CLASSES];
+extern const uint8_t UTF8SeqAction[UTF8SEQ_STATES][UTF8SEQ_CLASSES];
+
+/* initializes sequencer to idle state */
+void UTF8SeqInit(UTF8Seq *s);
+
+/* drains sequencer at end of stream, returns the number of out[] */
+int UTF8SeqFinish(UTF8Seq *s, UTF8SeqOut out[2]);
+
+/*! Sequencer is idle, next byte starts a new code. */
+static inline bool UTF8SeqIsIdle(const UTF8Seq *s)
+{	return s->State == UTF8SEQ_STATE_IDLE;
+}
+
+/*! Step a byte.
+ *  @param s points sequencer.
+ *  @param c byte to step.
+ *  @param out points output.
+ *  @return bool true: out is valid, false: no output.
+ */
+static inline bool UTF8SeqStep(UTF8Seq *s, uint8_t c, UTF8SeqOut *out)
+{	uint8_t		k;
+	uint8_t		a;
+
+	k = UTF8SeqClass[c];
+	a = UTF8SeqAction[s->State][k];
+	s->State = UTF8SeqNext[s->State][k];
+	if (a & UTF8SEQ_ACT_LOAD) {
+		s->Raw[0] = s->Pend;
+		s->RawCount = 1;
+	}
+	if (a & UTF8SEQ_ACT_START) {
+		s->Raw[0] = c;
+		s->RawCount = 1;
+	}
+	if (a & UTF8SEQ_ACT_APPEND) {
+		s->Raw[s->RawCount] = c;
+		s->RawCount++;
+	}
+	out->Bytes = s->Raw;
+	out->Len = (a & UTF8SEQ_ACT_EMIT) ? s->RawCount : 0;
+	out->Codes = a >> UTF8SEQ_ACT_CODES_SHIFT;
+	if (a & UTF8SEQ_ACT_PEND) {
+		s->Pend = c;
+	}
+	return (a & UTF8SEQ_ACT_GROW) != 0;
+}
+
+#endif /* (!defined(UTF8SEQ_H)) */
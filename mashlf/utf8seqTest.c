@@ -0,0 +1,453 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* Differential test of UTF-8 sequencer.
+ * Compares table driven DFA (utf8seq.c) to the switch based sequencer
+ * mashlf used before, output bytes and code counts at each step and
+ * at end of stream.
+ *  1. All 1 .. 3 bytes sequences.
+ *  2. All sequences of byte classes up to UTF8SEQ_TEST_CLASS_LENGTH,
+ *     bytes vary by position.
+ *  3. Random long sequences.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include "../mt19937ar/mt19937ar.h"
+#include "utf8seq.h"
+
+#define	__force_cast
+
+/* Maximum length of byte classes sequence. */
+#define	UTF8SEQ_TEST_CLASS_LENGTH	(8)
+/* Random sequences and their length. */
+#define	UTF8SEQ_TEST_RANDOMS		(10000)
+#define	UTF8SEQ_TEST_RANDOM_LENGTH	(1024)
+
+/* Log of outputs, bytes then code count as 0x100 + count. */
+#define	UTF8SEQ_TEST_LOG_SIZE	(UTF8SEQ_TEST_RANDOM_LENGTH * 8)
+
+typedef struct {
+	uint16_t	Ent[UTF8SEQ_TEST_LOG_SIZE];
+	size_t		Len;
+} TestLog;
+
+/* Reference, switch based sequencer. */
+#define UTF8SEQ_INIT	(0x00)
+#define UTF8SEQ_ASC	(0x01)
+/*! @note UTF8SEQ_R2, _R3, _R4 should be the number of encoded bytes. */
+#define UTF8SEQ_R2	(0x02)
+#define UTF8SEQ_R3	(0x03)
+#define UTF8SEQ_R4	(0x04)
+#define UTF8SEQ_FIELD	(0x08)
+
+typedef struct {
+	uint8_t		SeqRange;
+	uint8_t		SeqField;
+	uint8_t		PendingChar;
+	ssize_t		CodeCount;
+	ssize_t		CodeRawCount;
+	uint8_t		CodeRaw[5];
+} UTF8Sequencer;
+
+static void UTF8SequencerInit(UTF8Sequencer *us)
+{	us->SeqRange = UTF8SEQ_INIT;
+	us->SeqField = 0;
+	us->PendingChar = 0x00;
+	us->CodeCount = 0;
+	us->CodeRawCount = 0;
+	memset(&(us->CodeRaw[0]), 0, sizeof(us->CodeRaw));
+}
+
+static uint8_t UTF8SeqDetChar(uint8_t c)
+{	uint8_t		t;
+
+	if (c <= 0x7f) {
+		/* 00000000 .. 01111111 */
+		return UTF8SEQ_ASC;
+	}
+
+	t = c & 0xc0;
+	if (t == 0xc0) {
+		/* 11xxxxxx */
+		t = c & 0xe0;
+		if (t == 0xc0) {
+			/* 110xxxxx */
+			return UTF8SEQ_R2;
+		} else {
+			t = c & 0xf0;
+			if (t == 0xe0) {
+				/* 1110xxxx */
+				return UTF8SEQ_R3;
+			}
+			/* 1111xxxx */
+			return UTF8SEQ_R4;
+		}
+	} else {
+		/* 10xxxxxx */
+		return UTF8SEQ_FIELD;
+	}
+	return UTF8SEQ_ASC;
+}
+
+#define	UTF8SEQ_CHAR_NOP	(0xffff)
+#define	UTF8SEQ_CHAR_KNOCK	(0xfffe)
+
+/* @note We can repeat calling UTF8SequencerStepTock() twice or more.
+ */
+static void UTF8SequencerStepTock(UTF8Sequencer *us)
+{	uint8_t		r;
+	uint8_t		f;
+
+	r = us->SeqRange;
+	f = us->SeqField;
+	/* Adjust Sequence State */
+	switch (r) {
+	case UTF8SEQ_INIT:
+	case UTF8SEQ_ASC:
+		us->SeqField = 0;
+		us->PendingChar = 0x00;
+		us->CodeCount = 0;
+		us->CodeRawCount = 0;
+		break;
+	case UTF8SEQ_R2: /* A.Rx.R2 */
+	case UTF8SEQ_R3: /* A.Rx.R3 */
+	case UTF8SEQ_R4: /* A.Rx.R4 */
+		if ((f + 1) >= r) {
+			/* Got all encoded bytes. */
+			us->SeqRange = UTF8SEQ_INIT;
+			us->SeqField = 0;
+			us->PendingChar = 0x00;
+			us->CodeCount = 0;
+			us->CodeRawCount = 0;
+			break;
+		}
+		/* @note If come here, We are on one of
+		 * following state.
+		 *  1. Waiting succeeding encoded byte(s).
+		 *  2. PendingChar may have character to place
+		 *     CodeRaw[].
+		 */
+		break;
+	case UTF8SEQ_FIELD: /* A.F */
+		us->SeqRange = UTF8SEQ_INIT;
+		us->SeqField = 0;
+		us->PendingChar = 0x00;
+		us->CodeCount = 0;
+		us->CodeRawCount = 0;
+		break;
+	default: /* Will not come here. */
+		/* Do nothing */
+		break;
+	}
+}
+
+static ssize_t UTF8SequencerStepTick(UTF8Sequencer *us, uint16_t cc)
+{	uint8_t		pend;
+	uint8_t		r;
+	uint8_t		f;
+	uint8_t		det;
+	ssize_t		rcount;
+
+	r = us->SeqRange;
+	f = us->SeqField;
+
+	/* If there is pending char, buffer it to CodeRaw[]. */
+	pend = us->PendingChar;
+	if (pend != 0x00) {
+		/* There is pending character. */
+		/* @note: pending char range is [0x80 .. 0xff]. */
+		us->CodeRawCount = 1;
+		us->CodeRaw[0] = pend; /* P.To0 */
+		us->PendingChar = 0x00;
+	}
+
+	if (cc > ((uint8_t)~0x00)) {
+		/* Knocked, will flush bytes from CodeRaw[]. */
+		return us->CodeRawCount;
+	}
+
+	det = UTF8SeqDetChar((__force_cast uint8_t)cc);
+	switch (r) {
+	case UTF8SEQ_INIT:
+	case UTF8SEQ_ASC: /* R.ASC */
+		switch (det) {
+		case UTF8SEQ_ASC:
+			us->SeqRange = det;
+			us->SeqField = 0;
+			us->CodeCount = 1;
+			us->CodeRawCount = 1;
+			us->CodeRaw[0] = (__force_cast uint8_t)cc;
+			return 1;
+		case UTF8SEQ_R2:
+		case UTF8SEQ_R3:
+		case UTF8SEQ_R4:
+			us->SeqRange = det;
+			us->SeqField = 0;
+			us->CodeCount = 0;
+			us->CodeRawCount = 1;
+			us->CodeRaw[0] = (__force_cast uint8_t)cc;
+			return 0;
+		case UTF8SEQ_FIELD:
+			us->SeqRange = det;
+			us->SeqField = 0;
+			us->CodeCount = 1;
+			us->CodeRawCount = 1;
+			us->CodeRaw[0] = (__force_cast uint8_t)cc;
+			/* Will be adjusted at A.F */
+			return 1;
+		default: /* Will not come here. */
+			us->SeqRange = UTF8SEQ_ASC;
+			us->SeqField = 0;
+			us->CodeCount = 0;
+			us->CodeRawCount = 1;
+			us->CodeRaw[0] = (__force_cast uint8_t)cc;
+			return 1;
+		}
+	case UTF8SEQ_R2:
+	case UTF8SEQ_R3:
+	case UTF8SEQ_R4:
+		switch (det) {
+		case UTF8SEQ_FIELD:
+			f++;
+			/* Will be adjusted at Tock()
+			 * {A.Rx.R2, A.Rx.R3, A.Rx.R4}
+			 */
+			us->SeqField = f;
+			rcount = us->CodeRawCount;
+			us->CodeRaw[rcount] = (__force_cast uint8_t)cc;
+			rcount++;
+			us->CodeRawCount = rcount;
+			if ((f + 1) >= r) {
+				/* Got all encoded bytes. */
+				us->CodeCount = 1;
+				return rcount;
+			}
+			return 0;
+		case UTF8SEQ_ASC:
+			us->SeqRange = det;
+			us->SeqField = 0;
+			us->CodeCount = 2; /* Broken Rx and ASCII */
+			rcount = us->CodeRawCount;
+			us->CodeRaw[rcount] = (__force_cast uint8_t)cc;
+			rcount++;
+			/* Will be adjusted at R.ASC */
+			us->CodeRawCount = rcount;
+			return rcount;
+		case UTF8SEQ_R2:
+		case UTF8SEQ_R3:
+		case UTF8SEQ_R4:
+			us->SeqRange = det;
+			us->SeqField = 0;
+			/* Will be poped at P.To0 */
+			us->PendingChar = (__force_cast uint8_t)cc;
+			us->CodeCount = 1; /* Broken Rx */
+			rcount = us->CodeRawCount;
+			return rcount;
+		default: /* Will not come here. */
+			break;
+		}
+		/* Will not come here. */
+		us->SeqRange = UTF8SEQ_ASC;
+		us->SeqField = 0;
+		us->CodeCount = 2; /* Broken Rx and Broken something. */
+		rcount = us->CodeRawCount;
+		us->CodeRaw[rcount] = (__force_cast uint8_t)cc;
+		rcount++;
+		/* Will be adjusted at R.ASC */
+		us->CodeRawCount = rcount;
+		return rcount;
+	default: /* Will not come here. */
+		break;
+	}
+	/* Will not come here. */
+	us->SeqRange = UTF8SEQ_ASC;
+	us->SeqField = 0;
+	us->CodeCount = 1; /* Broken something. */
+	rcount = us->CodeRawCount;
+	us->CodeRaw[rcount] = (__force_cast uint8_t)cc;
+	rcount++;
+	/* Will be adjusted at R.ASC */
+	us->CodeRawCount = rcount;
+	return rcount;
+}
+
+/*! Append output to log. */
+static void LogOut(TestLog *log, const uint8_t *bytes, ssize_t len, ssize_t codes)
+{	ssize_t		i;
+
+	for (i = 0; i < len; i++) {
+		log->Ent[log->Len] = bytes[i];
+		log->Len++;
+	}
+	log->Ent[log->Len] = 0x100 + codes;
+	log->Len++;
+}
+
+/*! Same as MashLfPropagate() used with reference sequencer. */
+static void RefPropagate(TestLog *log, UTF8Sequencer *us, uint16_t cc)
+{	ssize_t		craw_len;
+	ssize_t		code_count;
+	const uint8_t	*craw;
+
+	if (cc != UTF8SEQ_CHAR_NOP) {
+		craw_len = UTF8SequencerStepTick(us, cc);
+		code_count = us->CodeCount;
+	} else {
+		craw_len = us->CodeRawCount;
+		code_count = 1;
+	}
+	if ((craw_len <= 0) || (code_count <= 0)) {
+		return;
+	}
+	craw = &(us->CodeRaw[0]);
+	if (*(craw + craw_len - 1) == '\n') {
+		code_count--;
+		craw_len--;
+	}
+	LogOut(log, craw, craw_len, code_count);
+}
+
+/*! Run reference sequencer. */
+static void RefRun(TestLog *log, const uint8_t *buf, size_t n)
+{	UTF8Sequencer	us;
+	size_t		i;
+
+	log->Len = 0;
+	UTF8SequencerInit(&us);
+	for (i = 0; i < n; i++) {
+		RefPropagate(log, &us, buf[i]);
+		UTF8SequencerStepTock(&us);
+	}
+	RefPropagate(log, &us, UTF8SEQ_CHAR_NOP);
+	RefPropagate(log, &us, UTF8SEQ_CHAR_KNOCK);
+}
+
+/*! Run table driven sequencer. */
+static void DfaRun(TestLog *log, const uint8_t *buf, size_t n)
+{	UTF8Seq		s;
+	UTF8SeqOut	out[2];
+	size_t		i;
+	int		m;
+	int		j;
+
+	log->Len = 0;
+	UTF8SeqInit(&s);
+	for (i = 0; i < n; i++) {
+		if (UTF8SeqStep(&s, buf[i], &out[0])) {
+			LogOut(log, out[0].Bytes, out[0].Len, out[0].Codes);
+		}
+	}
+	m = UTF8SeqFinish(&s, out);
+	for (j = 0; j < m; j++) {
+		LogOut(log, out[j].Bytes, out[j].Len, out[j].Codes);
+	}
+}
+
+static TestLog	RefLog;
+static TestLog	DfaLog;
+
+/*! Compare sequencers.
+ *  @return bool true: same, false: differ.
+ */
+static bool Compare(const uint8_t *buf, size_t n)
+{	size_t		i;
+
+	RefRun(&RefLog, buf, n);
+	DfaRun(&DfaLog, buf, n);
+	if ((RefLog.Len == DfaLog.Len) &&
+	    (memcmp(RefLog.Ent, DfaLog.Ent, RefLog.Len * sizeof(RefLog.Ent[0])) == 0)) {
+		return true;
+	}
+	printf("Differ: input=");
+	for (i = 0; i < n; i++) {
+		printf("%02x ", buf[i]);
+	}
+	printf("\n");
+	return false;
+}
+
+/* Byte class representatives, position is added. */
+static const uint8_t ClassBase[] = {
+	'A',	/* ASCII */
+	'\n',	/* LF */
+	0x80,	/* FIELD */
+	0xc0,	/* R2 */
+	0xe0,	/* R3 */
+	0xf0,	/* R4 */
+};
+
+int main(int argc, char **argv)
+{	uint8_t		buf[UTF8SEQ_TEST_RANDOM_LENGTH];
+	uint32_t	x;
+	uint32_t	r;
+	size_t		n;
+	size_t		i;
+	uint32_t	k;
+	int		fail = 0;
+
+	/* 1. All 1 .. 3 bytes sequences. */
+	for (n = 1; n <= 3; n++) {
+		for (x = 0; x < (1UL << (n * 8)); x++) {
+			for (i = 0; i < n; i++) {
+				buf[i] = (x >> (i * 8)) & 0xff;
+			}
+			if (!Compare(buf, n)) {
+				fail++;
+				break;
+			}
+		}
+	}
+
+	/* 2. All byte classes sequences. */
+	for (n = 0; n <= UTF8SEQ_TEST_CLASS_LENGTH; n++) {
+		uint32_t	combs = 1;
+
+		for (i = 0; i < n; i++) {
+			combs *= UTF8SEQ_CLASSES;
+		}
+		for (x = 0; x < combs; x++) {
+			k = x;
+			for (i = 0; i < n; i++) {
+				buf[i] = ClassBase[k % UTF8SEQ_CLASSES];
+				if (buf[i] != '\n') {
+					buf[i] += i;
+				}
+				k /= UTF8SEQ_CLASSES;
+			}
+			if (!Compare(buf, n)) {
+				fail++;
+				break;
+			}
+		}
+	}
+
+	/* 3. Random sequences, mostly non ASCII. */
+	init_genrand(5489);
+	for (k = 0; k < UTF8SEQ_TEST_RANDOMS; k++) {
+		n = genrand_uint32() % (UTF8SEQ_TEST_RANDOM_LENGTH + 1);
+		for (i = 0; i < n; i++) {
+			r = genrand_uint32();
+			switch (r & 0x3) {
+			case 0:
+				buf[i] = (r >> 8) & 0x7f;
+				break;
+			default:
+				buf[i] = 0x80 | ((r >> 8) & 0x7f);
+				break;
+			}
+		}
+		if (!Compare(buf, n)) {
+			fail++;
+			break;
+		}
+	}
+
+	if (fail) {
+		printf("FAIL: Table driven sequencer differs from reference.\n");
+		return 1;
+	}
+	printf("PASS: Table driven sequencer matches to reference.\n");
+	return 0;
+}
@@ -14,9 +14,10 @@ FileSizeMax=32768
 TextLineCharsMin=1
 TextLineCharsMax=128
 TextFile=
+BoundedSampling=
 BaseDirectory=./test
 
-while getopts "s:d:c:l:n:i:a:I:A:B:th" opt
+while getopts "s:d:c:l:n:i:a:I:A:B:tbh" opt
 do
 	case "${opt}" in
 	(s)
@@ -52,11 +53,14 @@ do
 	(t)
 		TextFile=yes
 		;;
+	(b)
+		BoundedSampling=yes
+		;;
 	(*)
 		echo "$0: HELP: Make file(s) randomly in random directory tree."
 		echo "$0: HELP: mk-files-tree.sh [-s seed] [-d depth] [-c characters] [-l length] \\"
 		echo "$0: HELP: [-n number_of_files] [-i file_size_min] [-a file_size_max] \\"
-		echo "$0: HELP: [-I text_line_min] [-A text_line_max] [-t] [-B directory]"
+		echo "$0: HELP: [-I text_line_min] [-A text_line_max] [-t] [-b] [-B directory]"
 		echo "$0: HELP: -s seed: random seed"
 		echo "$0: HELP: -d depth: directory depth"
 		echo "$0: HELP: -c characters: characters of directory name"
@@ -67,6 +71,9 @@ do
 		echo "$0: HELP: -I text_line_min: Min text line characters"
 		echo "$0: HELP: -A text_line_max: Max text line characters"
 		echo "$0: HELP: -t: Create text file (other wise binary file)"
+		echo "$0: HELP: -b: Draw file size and text line length by integer bounded"
+		echo "$0: HELP:     sampling (unbiased, no floating point). Creates different"
+		echo "$0: HELP:     tree from the one created without -b."
 		echo "$0: HELP: -B directory: Base directory"
 		echo "$0: HELP: NOTE: When create text file (using-t option), file_size_* means"
 		echo "$0: HELP: the number of characters except LF (Line Feed)."
@@ -80,6 +87,7 @@ echo -n	"-s ${Seed} -d ${Depth} -c ${DirectoryChars} "
 echo -n "-l ${FileNameLength} -n ${NumberOfFiles} -i ${FileSizeMin} -a ${FileSizeMax} "
 echo -n "-I ${TextLineCharsMin} -A ${TextLineCharsMax} "
 echo -n "-B \"${BaseDirectory}\" "
+[[ -n "${BoundedSampling}" ]] && echo -n "-b "
 [[ -n "${TextFile}" ]] && echo "-t" || "echo"
 
 # Write base64-no-slash encoded pseudo random sequence to stdout
@@ -89,14 +97,12 @@ echo -n "-B \"${BaseDirectory}\" "
 # * delete LF
 function RandBase64Str() {
 	local	result
-	local	prand_bin_len
 
-	prand_bin_len=$(( ( ( $1 + 3 ) / 4 ) * 3 ))
-	../prand/prand -s $2 ${prand_bin_len} | base64 | tr '/' '_' | tr -d '\n' | cut -c 1-$1
+	../prand/prand -s $2 -f b64 $1
 	result=$?
 	if (( ${result} != 0 ))
 	then
-		echo "$0.RandBase64Str: ERROR: May broken pipe. length=$1, seed=$2"
+		echo "$0.RandBase64Str: ERROR: prand exited with error. length=$1, seed=$2"
 		return ${result}
 	fi
 	return 0
@@ -108,11 +114,11 @@ function RandBase64Str() {
 function RandUint64() {
 	local	result
 
-	printf "%u" 0x$( ../prand/prand -s $1 8 | od -t x8 | head -1 | cut -d ' ' -f 2 )
+	../prand/prand -s $1 -f dec 1
 	result=$?
 	if (( ${result} != 0 ))
 	then
-		echo "$0.RandUint64: ERROR: May broken pipe. seed=$1"
+		echo "$0.RandUint64: ERROR: prand exited with error. seed=$1"
 		return ${result}
 	fi
 	return 0
@@ -124,11 +130,43 @@ function RandUint64() {
 function RandUint64Hex() {
 	local	result
 
-	echo "0x$( ../prand/prand -s $1 8 | od -t x8 | head -1 | cut -d ' ' -f 2 )"
+	../prand/prand -s $1 -f hex 1
+	result=$?
+	if (( ${result} != 0 ))
+	then
+		echo "$0.RandUint64Hex: ERROR: prand exited with error. seed=$1"
+		return ${result}
+	fi
+	return 0
+}
+
+# Write unsigned integer in [min, max] (in decimal) from seed
+# arg: min max seed
+# note: Same as floor( min + ( max - min + 1 ) * ( RandUint64 / 2^64 ) ).
+function RandUint64Ranged() {
+	local	result
+
+	../prand/prand -s $3 -f dec -r $1:$2 1
+	result=$?
+	if (( ${result} != 0 ))
+	then
+		echo "$0.RandUint64Ranged: ERROR: prand exited with error. min=$1, max=$2, seed=$3"
+		return ${result}
+	fi
+	return 0
+}
+
+# Write unsigned integer in [min, max] (in decimal) from seed
+# arg: min max seed
+# note: Unbiased integer bounded sampling, no floating point.
+function RandBounded() {
+	local	result
+
+	../prand/prand -s $3 -B $1:$2 1
 	result=$?
 	if (( ${result} != 0 ))
 	then
-		echo "$0.RandUint64Hex: ERROR: May broken pipe. seed=$1"
+		echo "$0.RandBounded: ERROR: prand exited with error. min=$1, max=$2, seed=$3"
 		return ${result}
 	fi
 	return 0
@@ -201,6 +239,7 @@ function FileNameToDirectory() {
 BaseDirectory="$( RemoveTrailingSlash "${BaseDirectory}" )"
 
 file_num=0
+Manifest=""
 
 while (( ${file_num} < ${NumberOfFiles} ))
 do
@@ -228,35 +267,32 @@ do
 		exit ${result}
 	fi
 
-	r64=$( RandUint64 ${seed_num} )
-	result=$?
-	if (( ${result} != 0 ))
-	then
-		exit ${result}
-	fi
-
-	file_size=$( calc "floor( ${FileSizeMin} + ( ${FileSizeMax} - ${FileSizeMin} + 1 ) * ( ${r64} / 18446744073709551616 ) )" )
-	result=$?
-	if (( ${result} != 0 ))
+	if [[ -n "${BoundedSampling}" ]]
 	then
-		echo "$0.main: ERROR: calc failed."
-		exit ${result}
+		file_size=$( RandBounded ${FileSizeMin} ${FileSizeMax} ${seed_num} )
+		result=$?
+		if (( ${result} != 0 ))
+		then
+			exit ${result}
+		fi
+	else
+		file_size=$( RandUint64Ranged ${FileSizeMin} ${FileSizeMax} ${seed_num} )
+		result=$?
+		if (( ${result} != 0 ))
+		then
+			exit ${result}
+		fi
 	fi
 
 	file_size=$( echo ${file_size} )
 	if [[ -z "${TextFile}" ]]
 	then
 		echo "${file_path}: Create. file_num=${file_num}, size=${file_size}"
-		../prand/prand -s ${seed_num} ${file_size} > "${file_path}"
-		result=$?
-		if (( ${result} != 0 ))
-		then
-			echo "$0.main: ERROR: prand exited with error. result=${result}"
-			exit ${result}
-		fi
+		# Binary files are created at once by prand manifest mode.
+		Manifest+="${seed_num} ${file_size} ${file_path}"$'\n'
 	else
 		echo "${file_path}: Create. file_num=${file_num}, size(text_chars)=${file_size}"
-		RandBase64Str ${file_size} ${seed_num} | ../mashlf/mashlf -i ${TextLineCharsMin} -a ${TextLineCharsMax} -s ${seed_num} > "${file_path}"
+		RandBase64Str ${file_size} ${seed_num} | ../mashlf/mashlf ${BoundedSampling:+-b} -i ${TextLineCharsMin} -a ${TextLineCharsMax} -s ${seed_num} > "${file_path}"
 		result=$?
 		if (( ${result} != 0 ))
 		then
@@ -266,4 +302,15 @@ do
 	fi
 	file_num=$(( ${file_num} + 1 ))
 done
+
+if [[ -n "${Manifest}" ]]
+then
+	echo -n "${Manifest}" | ../prand/prand -m -
+	result=$?
+	if (( ${result} != 0 ))
+	then
+		echo "$0.main: ERROR: prand exited with error. result=${result}"
+		exit ${result}
+	fi
+fi
 exit 0
@@ -0,0 +1,591 @@
+/*
+   A C-program for MT19937-64 (2004/9/29 version).
+   Coded by Takuji Nishimura and Makoto Matsumoto.
+
+   This is a 64-bit version of Mersenne Twister pseudorandom number
+   generator.
+
+   Before using, initialize the state by using init_genrand64(seed)
+   or init_by_array64(init_key, key_length).
+
+   Copyright (C) 2004, Makoto Matsumoto and Takuji Nishimura,
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+     1. Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+     2. Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+     3. The names of its contributors may not be used to endorse or promote
+        products derived from this software without specific prior written
+        permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+   References:
+   T. Nishimura, ``Tables of 64-bit Mersenne Twisters''
+     ACM Transactions on Modeling and
+     Computer Simulation 10. (2000) 348--357.
+   M. Matsumoto and T. Nishimura,
+     ``Mersenne Twister: a 623-dimensionally equidistributed
+       uniform pseudorandom number generator''
+     ACM Transactions on Modeling and
+     Computer Simulation 8. (Jan. 1998) 3--30.
+
+   Any feedback is very welcome.
+   http://www.math.hiroshima-u.ac.jp/~m-mat/MT/emt.html
+   email: m-mat @ math.sci.hiroshima-u.ac.jp (remove spaces)
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "mt19937-64.h"
+#include "mt19937-jump.h"
+
+/* Period parameters */
+#define NN MT19937_64_NN
+#define MM 156
+#define MATRIX_A (uint64_t)(0xB5026F5AA96619E9ULL) /*!< constant vector a */
+#define UM (uint64_t)(0xFFFFFFFF80000000ULL) /*!< Most significant 33 bits */
+#define LM (uint64_t)(0x7FFFFFFFULL) /*!< Least significant 31 bits */
+
+/*! the default context, used by non reentrant functions */
+static mt19937_64_ctx genrand64_ctx = MT19937_64_CTX_INITIALIZER;
+
+/*! makes context "not initialized"
+    @param ctx points context.
+    @note the 1st draw from ctx seeds it with 5489.
+*/
+void mt19937_64_ctx_init(mt19937_64_ctx *ctx)
+{
+    ctx->mti = NN+1;
+}
+
+/*! initializes ctx->mt[NN] with a seed
+    @param ctx points context.
+    @param seed random seed.
+*/
+void init_genrand64_r(mt19937_64_ctx *ctx, uint64_t seed)
+{
+    uint64_t *mt = ctx->mt;
+    int mti;
+
+    mt[0] = seed;
+    for (mti=1; mti<NN; mti++)
+        mt[mti] = (6364136223846793005ULL * (mt[mti-1] ^ (mt[mti-1] >> 62)) + mti);
+    ctx->mti = mti;
+}
+
+/*! initialize ctx by an array with array-length
+    @param ctx points context.
+    @param init_key points the array for initializing keys.
+    @param key_length the number of elements in array pointed by init_key
+*/
+void init_by_array64_r(mt19937_64_ctx *ctx, uint64_t init_key[], uint64_t key_length)
+{
+    uint64_t *mt = ctx->mt;
+    unsigned int i, j;
+    uint64_t k;
+    init_genrand64_r(ctx, 19650218ULL);
+    i=1; j=0;
+    k = (NN>key_length ? NN : key_length);
+    for (; k; k--) {
+        mt[i] = (mt[i] ^ ((mt[i-1] ^ (mt[i-1] >> 62)) * 3935559000370003845ULL))
+          + init_key[j] + j; /* non linear */
+        i++; j++;
+        if (i>=NN) { mt[0] = mt[NN-1]; i=1; }
+        if (j>=key_length) j=0;
+    }
+    for (k=NN-1; k; k--) {
+        mt[i] = (mt[i] ^ ((mt[i-1] ^ (mt[i-1] >> 62)) * 2862933555777941757ULL))
+          - i; /* non linear */
+        i++;
+        if (i>=NN) { mt[0] = mt[NN-1]; i=1; }
+    }
+
+    mt[0] = 1ULL << 63; /* MSB is 1; assuring non-zero initial array */
+}
+
+/*! computes next state word
+    @param x concatenated upper and lower bits of two state words.
+    @param m the word M words ahead.
+    @return uint64_t next state word.
+    @note uses mask instead of mag01[] table, it vectorizes.
+*/
+static inline uint64_t genrand64_twist_word(uint64_t x, uint64_t m)
+{
+    return m ^ (x >> 1) ^ ((uint64_t)(-(int64_t)(x & 1ULL)) & MATRIX_A);
+}
+
+/*! regenerates NN words of state vector
+    @param mt points state vector.
+*/
+static void genrand64_twist(uint64_t *mt)
+{
+    uint64_t x;
+    int i;
+
+    for (i=0;i<NN-MM;i++) {
+        x = (mt[i]&UM)|(mt[i+1]&LM);
+        mt[i] = genrand64_twist_word(x, mt[i+MM]);
+    }
+    for (;i<NN-1;i++) {
+        x = (mt[i]&UM)|(mt[i+1]&LM);
+        mt[i] = genrand64_twist_word(x, mt[i+(MM-NN)]);
+    }
+    x = (mt[NN-1]&UM)|(mt[0]&LM);
+    mt[NN-1] = genrand64_twist_word(x, mt[MM-1]);
+}
+
+/*! generates NN words at one time into ctx->mt[]
+    @param ctx points context.
+*/
+static void genrand64_next_state(mt19937_64_ctx *ctx)
+{
+    if (ctx->mti == NN+1)   /* if init_genrand64() has not been called, */
+        init_genrand64_r(ctx, 5489ULL); /* a default initial seed is used */
+
+    genrand64_twist(ctx->mt);
+    ctx->mti = 0;
+}
+
+/*! tempers a state word
+    @param x state word.
+    @return uint64_t tempered word.
+*/
+static inline uint64_t genrand64_temper(uint64_t x)
+{
+    x ^= (x >> 29) & 0x5555555555555555ULL;
+    x ^= (x << 17) & 0x71D67FFFEDA60000ULL;
+    x ^= (x << 37) & 0xFFF7EEE000000000ULL;
+    x ^= (x >> 43);
+
+    return x;
+}
+
+/*! generates a random number on [0, 2^64-1]-interval from ctx
+    @param ctx points context.
+    @return uint64_t generated random number.
+*/
+uint64_t genrand64_uint64_r(mt19937_64_ctx *ctx)
+{
+    if (ctx->mti >= NN) { /* generate NN words at one time */
+        genrand64_next_state(ctx);
+    }
+
+    return genrand64_temper(ctx->mt[ctx->mti++]);
+}
+
+/*! generates a random number on [0, 2^63-1]-interval from ctx
+    @param ctx points context.
+    @return int64_t generated random number.
+*/
+int64_t genrand64_int63_r(mt19937_64_ctx *ctx)
+{
+    return (int64_t)(genrand64_uint64_r(ctx) >> 1);
+}
+
+/*! generates a random number on [0,1]-real-interval from ctx
+    @param ctx points context.
+    @return double generated random number.
+*/
+double genrand64_real1_r(mt19937_64_ctx *ctx)
+{
+    return (genrand64_uint64_r(ctx) >> 11) * (1.0/9007199254740991.0);
+}
+
+/*! generates a random number on [0,1)-real-interval from ctx
+    @param ctx points context.
+    @return double generated random number.
+*/
+double genrand64_real2_r(mt19937_64_ctx *ctx)
+{
+    return (genrand64_uint64_r(ctx) >> 11) * (1.0/9007199254740992.0);
+}
+
+/*! generates a random number on (0,1)-real-interval from ctx
+    @param ctx points context.
+    @return double generated random number.
+*/
+double genrand64_real3_r(mt19937_64_ctx *ctx)
+{
+    return ((genrand64_uint64_r(ctx) >> 12) + 0.5) * (1.0/4503599627370496.0);
+}
+
+/*! fills array with random numbers on [0, 2^64-1]-interval from ctx
+    @param ctx points context.
+    @param dst points array to fill.
+    @param n the number of elements to fill.
+    @note dst[] is same sequence as calling genrand64_uint64_r() n times.
+*/
+void genrand64_fill_uint64(mt19937_64_ctx *ctx, uint64_t *dst, size_t n)
+{
+    const uint64_t *src;
+    size_t m;
+    size_t i;
+
+    while (n) {
+        if (ctx->mti >= NN) {
+            genrand64_next_state(ctx);
+        }
+        m = NN - ctx->mti;
+        if (m > n) {
+            m = n;
+        }
+        src = &(ctx->mt[ctx->mti]);
+        for (i = 0; i < m; i++) {
+            dst[i] = genrand64_temper(src[i]);
+        }
+        ctx->mti += (int)m;
+        dst += m;
+        n -= m;
+    }
+}
+
+/*! fills array with least significant 8 bits of random numbers from ctx
+    @param ctx points context.
+    @param dst points array to fill.
+    @param n the number of bytes to fill.
+    @note dst[i] is (uint8_t)genrand64_uint64_r(ctx) of i-th call.
+*/
+void genrand64_fill_uint8(mt19937_64_ctx *ctx, uint8_t *dst, size_t n)
+{
+    const uint64_t *src;
+    size_t m;
+    size_t i;
+
+    while (n) {
+        if (ctx->mti >= NN) {
+            genrand64_next_state(ctx);
+        }
+        m = NN - ctx->mti;
+        if (m > n) {
+            m = n;
+        }
+        src = &(ctx->mt[ctx->mti]);
+        for (i = 0; i < m; i++) {
+            dst[i] = (uint8_t)genrand64_temper(src[i]);
+        }
+        ctx->mti += (int)m;
+        dst += m;
+        n -= m;
+    }
+}
+
+/*! fills array with random numbers on [0,1)-real-interval from ctx
+    @param ctx points context.
+    @param dst points array to fill.
+    @param n the number of elements to fill.
+    @note dst[] is same sequence as calling genrand64_real2_r() n times.
+*/
+void genrand64_fill_real2(mt19937_64_ctx *ctx, double *dst, size_t n)
+{
+    const uint64_t *src;
+    size_t m;
+    size_t i;
+
+    while (n) {
+        if (ctx->mti >= NN) {
+            genrand64_next_state(ctx);
+        }
+        m = NN - ctx->mti;
+        if (m > n) {
+            m = n;
+        }
+        src = &(ctx->mt[ctx->mti]);
+        for (i = 0; i < m; i++) {
+            dst[i] = (genrand64_temper(src[i]) >> 11) * (1.0/9007199254740992.0);
+        }
+        ctx->mti += (int)m;
+        dst += m;
+        n -= m;
+    }
+}
+
+/*! skips words numbers
+    @param ctx points context.
+    @param words the number of words to skip.
+    @note linear time, but whole blocks are only regenerated.
+*/
+void genrand64_discard_r(mt19937_64_ctx *ctx, uint64_t words)
+{
+    uint64_t m;
+
+    while (words) {
+        if (ctx->mti >= NN) {
+            genrand64_next_state(ctx);
+        }
+        m = NN - ctx->mti;
+        if (m > words) {
+            m = words;
+        }
+        ctx->mti += (int)m;
+        words -= m;
+    }
+}
+
+/* Jump ahead.
+   The same method as genrand_jump_*() of mt19937ar.c. Let phi(x) be
+   the minimal polynomial of the output sequence and
+   q(x) = x^k mod phi(x), then the state k words ahead is the sum of
+   states 0 .. deg(q) words ahead weighted by coefficients of q(x),
+   evaluated by Horner's method on a ring of NN words.
+*/
+
+#define JUMP_MEXP MT19937_JUMP_MEXP /*!< degree of phi(x), Mersenne exponent */
+#define JUMP_POLY_BITS_WORD (64)
+
+/*! exponents of terms of phi(x) lower than x^JUMP_MEXP.
+    @note phi(x) is the minimal polynomial of output sequence,
+          computed by Berlekamp-Massey algorithm from 2*JUMP_MEXP
+          outputs. It has 285 terms including x^JUMP_MEXP.
+*/
+static const uint16_t genrand64_jump_phi_terms[] = {
+        0,   312,   468,  1092,  1248,  1716,  1872,  2028,
+     2496,  2652,  2808,  3120,  3276,  3432,  3588,  3900,
+     4056,  4368,  4680,  4992,  5303,  5460,  5613,  5615,
+     5616,  6078,  6084,  6234,  6237,  6240,  6388,  6390,
+     6396,  6543,  6544,  6546,  6552,  6702,  6855,  6858,
+     6864,  7008,  7014,  7163,  7164,  7170,  7176,  7475,
+     7632,  7636,  7644,  7787,  7788,  7791,  7792,  7938,
+     7956,  8093,  8094,  8099,  8103,  8112,  8250,  8256,
+     8268,  8406,  8411,  8412,  8558,  8713,  8714,  8717,
+     8723,  8868,  8870,  8880,  9023,  9024,  9026,  9035,
+     9036,  9048,  9182,  9333,  9335,  9338,  9347,  9360,
+     9494,  9650,  9798,  9953,  9954,  9957,  9961,  9984,
+    10110, 10116, 10266, 10271, 10272, 10295, 10422, 10434,
+    10578, 10581, 10583, 10589, 10590, 10605, 10607, 10734,
+    10746, 10890, 10902, 11046, 11054, 11070, 11202, 11205,
+    11209, 11210, 11213, 11226, 11229, 11358, 11364, 11366,
+    11380, 11382, 11514, 11519, 11520, 11522, 11535, 11536,
+    11538, 11670, 11678, 11694, 11826, 11829, 11831, 11834,
+    11847, 11850, 11982, 11990, 12000, 12006, 12138, 12146,
+    12155, 12156, 12162, 12294, 12450, 12453, 12457, 12467,
+    12606, 12612, 12624, 12628, 12762, 12767, 12768, 12779,
+    12780, 12783, 12784, 12918, 12930, 13074, 13077, 13079,
+    13085, 13086, 13091, 13095, 13230, 13242, 13248, 13386,
+    13398, 13403, 13404, 13542, 13550, 13698, 13701, 13705,
+    13706, 13709, 13715, 13854, 13860, 13862, 13872, 14010,
+    14015, 14016, 14018, 14027, 14028, 14166, 14174, 14322,
+    14325, 14327, 14330, 14339, 14478, 14486, 14634, 14642,
+    14790, 14946, 14949, 14953, 15102, 15108, 15258, 15263,
+    15264, 15414, 15426, 15570, 15573, 15575, 15581, 15582,
+    15726, 15738, 15882, 15894, 16038, 16046, 16194, 16197,
+    16201, 16202, 16205, 16350, 16356, 16358, 16506, 16511,
+    16512, 16514, 16662, 16670, 16818, 16821, 16823, 16826,
+    16974, 16982, 17130, 17138, 17286, 17442, 17445, 17449,
+    17598, 17604, 17754, 17759, 17760, 17910, 18066, 18069,
+    18071, 18222, 18378, 18534, 18690, 18693, 18846, 19002,
+    19158, 19314, 19470, 19626
+};
+
+/*! prepares jump ahead by words
+    @param jp points jump to prepare.
+    @param words the number of words to jump ahead.
+    @note jp can be applied to any number of contexts.
+*/
+void genrand64_jump_prepare(mt19937_64_jump *jp, uint64_t words)
+{
+    jp->words = words;
+    memset(jp->poly, 0, sizeof(jp->poly));
+    if ((words / NN) > MT19937_64_JUMP_DIRECT_BLOCKS) {
+        mt19937_jump_pow_x(jp->poly, MT19937_64_JUMP_POLY_WORDS, (words / NN) * NN,
+            genrand64_jump_phi_terms,
+            sizeof(genrand64_jump_phi_terms) / sizeof(genrand64_jump_phi_terms[0]));
+    }
+}
+
+/*! regenerates one word on the ring state
+    @param ring points ring of NN words.
+    @param i index of the oldest word, replaced with new word.
+*/
+static inline void jump_ring_next(uint64_t *ring, int i)
+{
+    uint64_t x;
+    int i1 = i + 1;
+    int im = i + MM;
+
+    if (i1 >= NN) i1 -= NN;
+    if (im >= NN) im -= NN;
+    x = (ring[i]&UM)|(ring[i1]&LM);
+    ring[i] = genrand64_twist_word(x, ring[im]);
+}
+
+#if (!defined(JUMP_WINDOW))
+#define JUMP_WINDOW (4) /*!< coefficients of poly(x) added at once, divides 64 */
+#endif
+
+/*! moves block aligned state ahead by poly(A)
+    @param mt points state vector, regenerated block.
+    @param poly points jump polynomial.
+    @note Horner's method steps JUMP_WINDOW coefficients at once,
+          adds one of precomputed sums of mt .. A^(JUMP_WINDOW-1) mt.
+*/
+static void jump_horner(uint64_t *mt, const uint64_t *poly)
+{
+    uint64_t acc[NN];
+    uint64_t table[1 << JUMP_WINDOW][NN];
+    uint64_t h;
+    int deg, d, i, j, k;
+
+    for (deg = JUMP_MEXP - 1; deg >= 0; deg--) {
+        if ((poly[deg / JUMP_POLY_BITS_WORD] >> (deg % JUMP_POLY_BITS_WORD)) & 0x1)
+            break;
+    }
+
+    /* table[k] = sum of A^j mt for bit j of k, in linear order. */
+    memcpy(acc, mt, sizeof(acc));
+    memset(table[0], 0, sizeof(table[0]));
+    for (j = 0; j < JUMP_WINDOW; j++) {
+        for (k = 0; k < NN; k++)
+            table[1 << j][k] = acc[(j + k) % NN];
+        for (k = 1; k < (1 << j); k++) {
+            for (i = 0; i < NN; i++)
+                table[(1 << j) + k][i] = table[1 << j][i] ^ table[k][i];
+        }
+        jump_ring_next(acc, j);
+    }
+
+    memset(acc, 0, sizeof(acc));
+    i = 0;
+    for (d = deg - (deg % JUMP_WINDOW); d >= 0; d -= JUMP_WINDOW) {
+        /* acc = A^JUMP_WINDOW acc */
+        for (k = 0; k < JUMP_WINDOW; k++) {
+            jump_ring_next(acc, i);
+            i++;
+            if (i >= NN) i = 0;
+        }
+        /* d is multiple of JUMP_WINDOW, window is in a word. */
+        h = (poly[d / JUMP_POLY_BITS_WORD] >> (d % JUMP_POLY_BITS_WORD))
+            & ((1 << JUMP_WINDOW) - 1);
+        if (h) {
+            /* acc += table[h] */
+            for (j = 0; j < (NN - i); j++)
+                acc[i + j] ^= table[h][j];
+            for (; j < NN; j++)
+                acc[i + j - NN] ^= table[h][j];
+        }
+    }
+    for (j = 0; j < (NN - i); j++)
+        mt[j] = acc[i + j];
+    for (; j < NN; j++)
+        mt[j] = acc[i + j - NN];
+}
+
+/*! jumps ahead ctx by prepared jump
+    @param ctx points context.
+    @param jp points prepared jump.
+    @note after jump, ctx generates the same numbers as skipping
+          jp->words numbers by genrand64_uint64_r().
+*/
+void genrand64_jump_apply_r(mt19937_64_ctx *ctx, const mt19937_64_jump *jp)
+{
+    uint64_t blocks;
+    int rest;
+
+    if (ctx->mti >= NN) {
+        /* Start from regenerated block, all words follow recurrence. */
+        genrand64_next_state(ctx);
+    }
+
+    blocks = jp->words / NN;
+    rest = (int)(jp->words % NN);
+    if (blocks > MT19937_64_JUMP_DIRECT_BLOCKS) {
+        jump_horner(ctx->mt, jp->poly);
+    } else {
+        for (; blocks > 0; blocks--)
+            genrand64_twist(ctx->mt);
+    }
+
+    ctx->mti += rest;
+    if (ctx->mti >= NN) {
+        ctx->mti -= NN;
+        genrand64_twist(ctx->mt);
+    }
+}
+
+/*! jumps ahead ctx by words
+    @param ctx points context.
+    @param words the number of words to jump ahead.
+*/
+void genrand64_jump_r(mt19937_64_ctx *ctx, uint64_t words)
+{
+    mt19937_64_jump jp;
+
+    genrand64_jump_prepare(&jp, words);
+    genrand64_jump_apply_r(ctx, &jp);
+}
+
+/*! initializes mt[NN] with a seed
+    @param seed random seed.
+*/
+void init_genrand64(uint64_t seed)
+{
+    init_genrand64_r(&genrand64_ctx, seed);
+}
+
+/*! initialize by an array with array-length
+    @param init_key points the array for initializing keys.
+    @param key_length the number of elements in array pointed by init_key
+*/
+void init_by_array64(uint64_t init_key[], uint64_t key_length)
+{
+    init_by_array64_r(&genrand64_ctx, init_key, key_length);
+}
+
+/*! generates a random number on [0, 2^64-1]-interval
+    @return uint64_t generated random number.
+*/
+uint64_t genrand64_uint64(void)
+{
+    return genrand64_uint64_r(&genrand64_ctx);
+}
+
+/*! generates a random number on [0, 2^63-1]-interval
+    @return int64_t generated random number.
+*/
+int64_t genrand64_int63(void)
+{
+    return genrand64_int63_r(&genrand64_ctx);
+}
+
+/*! generates a random number on [0,1]-real-interval
+    @return double generated random number.
+*/
+double genrand64_real1(void)
+{
+    return genrand64_real1_r(&genrand64_ctx);
+}
+
+/*! generates a random number on [0,1)-real-interval
+    @return double generated random number.
+*/
+double genrand64_real2(void)
+{
+    return genrand64_real2_r(&genrand64_ctx);
+}
+
+/*! generates a random number on (0,1)-real-interval
+    @return double generated random number.
+*/
+double genrand64_real3(void)
+{
+    return genrand64_real3_r(&genrand64_ctx);
+}
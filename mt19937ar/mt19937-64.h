@@ -0,0 +1,165 @@
+/*
+   A C-program for MT19937-64 (2004/9/29 version).
+   Coded by Takuji Nishimura and Makoto Matsumoto.
+
+   This is a 64-bit version of Mersenne Twister pseudorandom number
+   generator.
+
+   Before using, initialize the state by using init_genrand64(seed)
+   or init_by_array64(init_key, key_length).
+
+   Copyright (C) 2004, Makoto Matsumoto and Takuji Nishimura,
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+     1. Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+     2. Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+     3. The names of its contributors may not be used to endorse or promote
+        products derived from this software without specific prior written
+        permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+   References:
+   T. Nishimura, ``Tables of 64-bit Mersenne Twisters''
+     ACM Transactions on Modeling and
+     Computer Simulation 10. (2000) 348--357.
+   M. Matsumoto and T. Nishimura,
+     ``Mersenne Twister: a 623-dimensionally equidistributed
+       uniform pseudorandom number generator''
+     ACM Transactions on Modeling and
+     Computer Simulation 8. (Jan. 1998) 3--30.
+
+   Any feedback is very welcome.
+   http://www.math.hiroshima-u.ac.jp/~m-mat/MT/emt.html
+   email: m-mat @ math.sci.hiroshima-u.ac.jp (remove spaces)
+*/
+
+#if (!defined(MT19937_64_H))
+#define MT19937_64_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "mt19937ar.h"
+
+/* Period parameters */
+#define MT19937_64_NN	(312)	/*!< the number of words in the state vector */
+
+/*! MT19937-64 generator state (context).
+    @note Each thread should own its context. The context is aligned
+          to a cache line, so contexts never share a cache line.
+*/
+typedef struct mt19937_64_ctx {
+    uint64_t mt[MT19937_64_NN]; /*!< the array for the state vector  */
+    int mti; /*!< mti==NN+1 means mt[NN] is not initialized */
+} MT19937AR_CACHE_ALIGNED mt19937_64_ctx;
+
+/*! Static initializer of not seeded context. */
+#define MT19937_64_CTX_INITIALIZER { .mti = MT19937_64_NN + 1 }
+
+/* makes ctx "not initialized", the 1st draw seeds it with 5489 */
+void mt19937_64_ctx_init(mt19937_64_ctx *ctx);
+
+/* initializes ctx->mt[NN] with a seed */
+void init_genrand64_r(mt19937_64_ctx *ctx, uint64_t seed);
+
+/* initialize ctx by an array with array-length */
+void init_by_array64_r(mt19937_64_ctx *ctx, uint64_t init_key[], uint64_t key_length);
+
+/* generates a random number on [0, 2^64-1]-interval from ctx */
+uint64_t genrand64_uint64_r(mt19937_64_ctx *ctx);
+
+/* generates a random number on [0, 2^63-1]-interval from ctx */
+int64_t genrand64_int63_r(mt19937_64_ctx *ctx);
+
+/* generates a random number on [0,1]-real-interval from ctx */
+double genrand64_real1_r(mt19937_64_ctx *ctx);
+
+/* generates a random number on [0,1)-real-interval from ctx */
+double genrand64_real2_r(mt19937_64_ctx *ctx);
+
+/* generates a random number on (0,1)-real-interval from ctx */
+double genrand64_real3_r(mt19937_64_ctx *ctx);
+
+/* Bulk fill functions, produce the same sequence as calling */
+/* corresponding single number function n times. */
+
+/* fills dst[n] with random numbers on [0, 2^64-1]-interval */
+void genrand64_fill_uint64(mt19937_64_ctx *ctx, uint64_t *dst, size_t n);
+
+/* fills dst[n] with least significant 8 bits of random numbers */
+void genrand64_fill_uint8(mt19937_64_ctx *ctx, uint8_t *dst, size_t n);
+
+/* fills dst[n] with random numbers on [0,1)-real-interval */
+void genrand64_fill_real2(mt19937_64_ctx *ctx, double *dst, size_t n);
+
+/* skips words numbers, whole blocks are regenerated without tempering */
+void genrand64_discard_r(mt19937_64_ctx *ctx, uint64_t words);
+
+/* Jump ahead functions. */
+
+/*! the number of 64 bit words holding jump polynomial */
+#define MT19937_64_JUMP_POLY_WORDS	(312)
+/*! jumps up to this number of blocks (NN words) regenerate directly */
+#define MT19937_64_JUMP_DIRECT_BLOCKS	(4096)
+
+/*! Prepared jump, x^(NN * floor(words / NN)) mod phi(x) */
+typedef struct mt19937_64_jump {
+    uint64_t words; /*!< the number of words to jump ahead */
+    uint64_t poly[MT19937_64_JUMP_POLY_WORDS]; /*!< jump polynomial */
+} mt19937_64_jump;
+
+/* prepares jump ahead by words, may be applied to many contexts */
+void genrand64_jump_prepare(mt19937_64_jump *jp, uint64_t words);
+
+/* jumps ahead ctx by prepared jump */
+void genrand64_jump_apply_r(mt19937_64_ctx *ctx, const mt19937_64_jump *jp);
+
+/* jumps ahead ctx by words, same as skipping words numbers */
+void genrand64_jump_r(mt19937_64_ctx *ctx, uint64_t words);
+
+/* Following functions use the default (process global) context. */
+
+/* initializes mt[NN] with a seed */
+void init_genrand64(uint64_t seed);
+
+/* initialize by an array with array-length */
+/* init_key is the array for initializing keys */
+/* key_length is its length */
+void init_by_array64(uint64_t init_key[], uint64_t key_length);
+
+/* generates a random number on [0, 2^64-1]-interval */
+uint64_t genrand64_uint64(void);
+
+/* generates a random number on [0, 2^63-1]-interval */
+int64_t genrand64_int63(void);
+
+/* generates a random number on [0,1]-real-interval */
+double genrand64_real1(void);
+
+/* generates a random number on [0,1)-real-interval */
+double genrand64_real2(void);
+
+/* generates a random number on (0,1)-real-interval */
+double genrand64_real3(void);
+
+#endif /* (!defined(MT19937_64_H)) */
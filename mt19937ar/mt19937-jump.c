@@ -0,0 +1,124 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* GF(2) polynomial arithmetic for jump ahead of MT19937 and MT19937-64.
+ * Polynomials are bit arrays in 64 bit words, bit i is coefficient
+ * of x^i. See mt19937ar.c for how the jump uses x^e mod phi(x).
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "mt19937-jump.h"
+
+#define	MEXP		MT19937_JUMP_MEXP
+#define	BITS_WORD	(64)
+/*! Words of square before reduction, and a word to shift into. */
+#define	WIDE_WORDS	(2 * MT19937_JUMP_POLY_WORDS_MAX + 1)
+
+/*! Extract width bits at bit offset pos. */
+static inline uint64_t poly_bits(const uint64_t *a, int pos, int width)
+{	int		w = pos / BITS_WORD;
+	int		sh = pos % BITS_WORD;
+	uint64_t	v;
+
+	v = a[w] >> sh;
+	if (sh != 0) {
+		v |= a[w + 1] << (BITS_WORD - sh);
+	}
+	if (width < BITS_WORD) {
+		v &= (((uint64_t)1) << width) - 1;
+	}
+	return v;
+}
+
+/*! Add (xor) v at bit offset pos. */
+static inline void poly_add_bits(uint64_t *a, int pos, uint64_t v)
+{	int		w = pos / BITS_WORD;
+	int		sh = pos % BITS_WORD;
+
+	a[w] ^= v << sh;
+	if (sh != 0) {
+		a[w + 1] ^= v >> (BITS_WORD - sh);
+	}
+}
+
+/*! Reduce polynomial a(x) of degree <= top modulo phi(x).
+ *  @param a points polynomial, WIDE_WORDS words.
+ *  @param top the highest bit may be set.
+ *  @param terms exponents of terms of phi(x) lower than x^MEXP.
+ *  @param nterms the number of terms[].
+ *  @note The highest of terms[] should be 64 or more below MEXP.
+ */
+static void poly_mod(uint64_t *a, int top, const uint16_t *terms, int nterms)
+{	int		lo;
+	int		width;
+	int		t;
+	uint64_t	h;
+
+	/* x^(MEXP+i) = sum of x^(term+i), process 64 terms at once.
+	 * Folding never sets bits in [lo, top], see note.
+	 */
+	while (top >= MEXP) {
+		lo = top - (BITS_WORD - 1);
+		if (lo < MEXP) {
+			lo = MEXP;
+		}
+		width = top - lo + 1;
+		h = poly_bits(a, lo, width);
+		if (h != 0) {
+			poly_add_bits(a, lo, h);
+			for (t = 0; t < nterms; t++) {
+				poly_add_bits(a, terms[t] + lo - MEXP, h);
+			}
+		}
+		top = lo - 1;
+	}
+}
+
+/*! Spread 32 bits into even bits of 64 bits, squaring over GF(2). */
+static inline uint64_t poly_spread(uint32_t v)
+{	uint64_t	x = v;
+
+	x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+	x = (x | (x << 8)) & 0x00ff00ff00ff00ffULL;
+	x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	x = (x | (x << 2)) & 0x3333333333333333ULL;
+	x = (x | (x << 1)) & 0x5555555555555555ULL;
+	return x;
+}
+
+/*! Compute q(x) = x^e mod phi(x) by square and multiply.
+ *  @param q points result polynomial, words words.
+ *  @param words words of q, holds MEXP bits, up to
+ *         MT19937_JUMP_POLY_WORDS_MAX.
+ *  @param e exponent.
+ *  @param terms exponents of terms of phi(x) lower than x^MEXP.
+ *  @param nterms the number of terms[].
+ */
+void mt19937_jump_pow_x(uint64_t *q, int words, uint64_t e,
+	const uint16_t *terms, int nterms)
+{	uint64_t	a[WIDE_WORDS];
+	int		bit;
+	int		i;
+
+	memset(a, 0, sizeof(a));
+	a[0] = 1; /* 1 */
+	for (bit = 63; bit >= 0; bit--) {
+		if ((e >> bit) == 0) {
+			continue;
+		}
+		/* a = a^2 mod phi */
+		for (i = words - 1; i >= 0; i--) {
+			a[2 * i + 1] = poly_spread((uint32_t)(a[i] >> 32));
+			a[2 * i] = poly_spread((uint32_t)(a[i]));
+		}
+		poly_mod(a, 2 * (MEXP - 1), terms, nterms);
+		if ((e >> bit) & 0x1) {
+			/* a = x * a mod phi */
+			for (i = words; i > 0; i--) {
+				a[i] = (a[i] << 1) | (a[i - 1] >> (BITS_WORD - 1));
+			}
+			a[0] <<= 1;
+			poly_mod(a, MEXP, terms, nterms);
+		}
+	}
+	memcpy(q, a, sizeof(q[0]) * words);
+}
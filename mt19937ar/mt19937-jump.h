@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* GF(2) polynomial arithmetic for jump ahead of MT19937 and MT19937-64.
+ * Internal interface of mt19937ar.c and mt19937-64.c, both generators
+ * have characteristic polynomial phi(x) of degree 19937, they differ in
+ * terms of phi(x) only.
+ */
+#if (!defined(MT19937_JUMP_H))
+#define MT19937_JUMP_H
+#include <stddef.h>
+#include <stdint.h>
+
+/*! Degree of phi(x), Mersenne exponent. */
+#define	MT19937_JUMP_MEXP	(19937)
+
+/*! The maximum number of 64 bit words of polynomial modulo phi(x). */
+#define	MT19937_JUMP_POLY_WORDS_MAX	(312)
+
+/* computes q(x) = x^e mod phi(x),
+ * phi(x) = x^MT19937_JUMP_MEXP + sum of x^terms[i] (i < nterms)
+ */
+void mt19937_jump_pow_x(uint64_t *q, int words, uint64_t e,
+	const uint16_t *terms, int nterms);
+
+#endif /* (!defined(MT19937_JUMP_H)) */
@@ -0,0 +1,351 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* MT19937 state regeneration and tempering kernels.
+ * Vectorized with AVX-512F, AVX2 or SSE2 when the compiler targets
+ * them, otherwise plain scalar code.
+ * Compiled once per ISA variant, see MT19937AR_KERNEL_ISAS in
+ * Makefile.inc, mt19937ar.c picks one variant at run time.
+ * Vectorizing the regeneration (twist) is safe while lanes fit in
+ * the recurrence distance, N - M = 227 words, each lane reads words
+ * those are already regenerated or not yet overwritten.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#if (defined(__SSE2__))
+#include <immintrin.h>
+#endif /* (defined(__SSE2__)) */
+#include "mt19937ar.h"
+#include "mt19937ar-kernel.h"
+
+/* Period parameters */
+#define N MT19937AR_N
+#define M 397
+#define MATRIX_A (uint32_t)(0x9908b0dfUL)   /*!< constant vector a */
+#define UPPER_MASK (uint32_t)(0x80000000UL) /*!< most significant w-r bits */
+#define LOWER_MASK (uint32_t)(0x7fffffffUL) /*!< least significant r bits */
+
+/* Tempering parameters */
+#define TEMPERING_MASK_B (uint32_t)(0x9d2c5680UL)
+#define TEMPERING_MASK_C (uint32_t)(0xefc60000UL)
+
+#if (!defined(MT19937AR_KERNEL_ISA))
+#define MT19937AR_KERNEL_ISA	baseline
+#endif /* (!defined(MT19937AR_KERNEL_ISA)) */
+
+#define KERNEL_CONCAT2(a, b)	a ## _ ## b
+#define KERNEL_CONCAT(a, b)	KERNEL_CONCAT2(a, b)
+/*! Kernel set symbol of this variant, mt19937ar_kernel_ISA */
+#define KERNEL_SYMBOL		KERNEL_CONCAT(mt19937ar_kernel, MT19937AR_KERNEL_ISA)
+#define KERNEL_STRING2(a)	#a
+#define KERNEL_STRING(a)	KERNEL_STRING2(a)
+#define KERNEL_NAME		KERNEL_STRING(MT19937AR_KERNEL_ISA)
+
+#if (defined(__AVX512F__))
+#define KERNEL_LANES	(16)
+#elif (defined(__AVX2__))
+#define KERNEL_LANES	(8)
+#elif (defined(__SSE2__))
+#define KERNEL_LANES	(4)
+#else
+#define KERNEL_LANES	(1)
+#endif
+
+/*! Regenerate one word. */
+static inline uint32_t twist_word(uint32_t u, uint32_t l, uint32_t m)
+{	uint32_t	y;
+
+	y = (u & UPPER_MASK) | (l & LOWER_MASK);
+#if (defined(CONFIG_2SCOMP))
+	return m ^ ((uint32_t)(0 - (y & 0x1UL)) & MATRIX_A) ^ (y >> 1);
+#else /* (defined(CONFIG_2SCOMP)) */
+	{	static const uint32_t mag01[2] = {0x0UL, MATRIX_A};
+
+		return m ^ (y >> 1) ^ mag01[y & 0x1UL];
+	}
+#endif /* (defined(CONFIG_2SCOMP)) */
+}
+
+/*! Temper one word. */
+static inline uint32_t temper_word(uint32_t y)
+{	y ^= (y >> 11);
+	y ^= (y << 7) & TEMPERING_MASK_B;
+	y ^= (y << 15) & TEMPERING_MASK_C;
+	y ^= (y >> 18);
+	return y;
+}
+
+#if (defined(__AVX512F__))
+typedef __m512i	vec_u32;
+
+static inline vec_u32 vec_load(const uint32_t *p)
+{	return _mm512_loadu_si512((const void *)p);
+}
+
+static inline void vec_store(uint32_t *p, vec_u32 v)
+{	_mm512_storeu_si512((void *)p, v);
+}
+
+static inline vec_u32 vec_twist(vec_u32 u, vec_u32 l, vec_u32 m)
+{	vec_u32		y;
+	vec_u32		mag;
+
+	/* y = (u & UPPER_MASK) | (l & LOWER_MASK) */
+	y = _mm512_ternarylogic_epi32(u, l, _mm512_set1_epi32((int)UPPER_MASK), 0xe4);
+	mag = _mm512_srai_epi32(_mm512_slli_epi32(y, 31), 31);
+	mag = _mm512_and_si512(mag, _mm512_set1_epi32((int)MATRIX_A));
+	return _mm512_xor_si512(_mm512_xor_si512(m, _mm512_srli_epi32(y, 1)), mag);
+}
+
+static inline vec_u32 vec_temper(vec_u32 y)
+{	y = _mm512_xor_si512(y, _mm512_srli_epi32(y, 11));
+	y = _mm512_xor_si512(y, _mm512_and_si512(_mm512_slli_epi32(y, 7),
+		_mm512_set1_epi32((int)TEMPERING_MASK_B)));
+	y = _mm512_xor_si512(y, _mm512_and_si512(_mm512_slli_epi32(y, 15),
+		_mm512_set1_epi32((int)TEMPERING_MASK_C)));
+	y = _mm512_xor_si512(y, _mm512_srli_epi32(y, 18));
+	return y;
+}
+
+/*! Temper KERNEL_LANES words, store least significant 8 bits. */
+static inline void vec_temper_uint8(uint8_t *dst, const uint32_t *src)
+{	_mm_storeu_si128((__m128i *)dst,
+		_mm512_cvtepi32_epi8(vec_temper(vec_load(src)))
+	);
+}
+
+/*! Temper KERNEL_LANES words, store as [0,1)-real-interval. */
+static inline void vec_temper_real2(double *dst, const uint32_t *src)
+{	vec_u32		t;
+	__m512d		scale;
+
+	scale = _mm512_set1_pd(1.0/4294967296.0);
+	t = vec_temper(vec_load(src));
+	_mm512_storeu_pd(dst, _mm512_mul_pd(
+		_mm512_cvtepu32_pd(_mm512_castsi512_si256(t)), scale)
+	);
+	_mm512_storeu_pd(dst + 8, _mm512_mul_pd(
+		_mm512_cvtepu32_pd(_mm512_extracti64x4_epi64(t, 1)), scale)
+	);
+}
+#elif (defined(__AVX2__))
+typedef __m256i	vec_u32;
+
+static inline vec_u32 vec_load(const uint32_t *p)
+{	return _mm256_loadu_si256((const __m256i *)p);
+}
+
+static inline void vec_store(uint32_t *p, vec_u32 v)
+{	_mm256_storeu_si256((__m256i *)p, v);
+}
+
+static inline vec_u32 vec_twist(vec_u32 u, vec_u32 l, vec_u32 m)
+{	vec_u32		y;
+	vec_u32		mag;
+
+	y = _mm256_or_si256(
+		_mm256_and_si256(u, _mm256_set1_epi32((int)UPPER_MASK)),
+		_mm256_and_si256(l, _mm256_set1_epi32((int)LOWER_MASK))
+	);
+	mag = _mm256_srai_epi32(_mm256_slli_epi32(y, 31), 31);
+	mag = _mm256_and_si256(mag, _mm256_set1_epi32((int)MATRIX_A));
+	return _mm256_xor_si256(_mm256_xor_si256(m, _mm256_srli_epi32(y, 1)), mag);
+}
+
+static inline vec_u32 vec_temper(vec_u32 y)
+{	y = _mm256_xor_si256(y, _mm256_srli_epi32(y, 11));
+	y = _mm256_xor_si256(y, _mm256_and_si256(_mm256_slli_epi32(y, 7),
+		_mm256_set1_epi32((int)TEMPERING_MASK_B)));
+	y = _mm256_xor_si256(y, _mm256_and_si256(_mm256_slli_epi32(y, 15),
+		_mm256_set1_epi32((int)TEMPERING_MASK_C)));
+	y = _mm256_xor_si256(y, _mm256_srli_epi32(y, 18));
+	return y;
+}
+
+/*! Temper KERNEL_LANES words, store least significant 8 bits. */
+static inline void vec_temper_uint8(uint8_t *dst, const uint32_t *src)
+{	vec_u32		t;
+	__m128i		b;
+
+	t = _mm256_and_si256(vec_temper(vec_load(src)), _mm256_set1_epi32(0xff));
+	b = _mm_packs_epi32(_mm256_castsi256_si128(t), _mm256_extracti128_si256(t, 1));
+	b = _mm_packus_epi16(b, b);
+	_mm_storel_epi64((__m128i *)dst, b);
+}
+
+/*! Temper KERNEL_LANES words, store as [0,1)-real-interval. */
+static inline void vec_temper_real2(double *dst, const uint32_t *src)
+{	vec_u32		t;
+	__m256d		bias;
+	__m256d		scale;
+
+	/* No unsigned conversion, convert signed (t - 2^31) and add 2^31. */
+	bias = _mm256_set1_pd(2147483648.0);
+	scale = _mm256_set1_pd(1.0/4294967296.0);
+	t = _mm256_xor_si256(vec_temper(vec_load(src)), _mm256_set1_epi32((int)UPPER_MASK));
+	_mm256_storeu_pd(dst, _mm256_mul_pd(_mm256_add_pd(
+		_mm256_cvtepi32_pd(_mm256_castsi256_si128(t)), bias), scale)
+	);
+	_mm256_storeu_pd(dst + 4, _mm256_mul_pd(_mm256_add_pd(
+		_mm256_cvtepi32_pd(_mm256_extracti128_si256(t, 1)), bias), scale)
+	);
+}
+#elif (defined(__SSE2__))
+typedef __m128i	vec_u32;
+
+static inline vec_u32 vec_load(const uint32_t *p)
+{	return _mm_loadu_si128((const __m128i *)p);
+}
+
+static inline void vec_store(uint32_t *p, vec_u32 v)
+{	_mm_storeu_si128((__m128i *)p, v);
+}
+
+static inline vec_u32 vec_twist(vec_u32 u, vec_u32 l, vec_u32 m)
+{	vec_u32		y;
+	vec_u32		mag;
+
+	y = _mm_or_si128(
+		_mm_and_si128(u, _mm_set1_epi32((int)UPPER_MASK)),
+		_mm_and_si128(l, _mm_set1_epi32((int)LOWER_MASK))
+	);
+	mag = _mm_srai_epi32(_mm_slli_epi32(y, 31), 31);
+	mag = _mm_and_si128(mag, _mm_set1_epi32((int)MATRIX_A));
+	return _mm_xor_si128(_mm_xor_si128(m, _mm_srli_epi32(y, 1)), mag);
+}
+
+static inline vec_u32 vec_temper(vec_u32 y)
+{	y = _mm_xor_si128(y, _mm_srli_epi32(y, 11));
+	y = _mm_xor_si128(y, _mm_and_si128(_mm_slli_epi32(y, 7),
+		_mm_set1_epi32((int)TEMPERING_MASK_B)));
+	y = _mm_xor_si128(y, _mm_and_si128(_mm_slli_epi32(y, 15),
+		_mm_set1_epi32((int)TEMPERING_MASK_C)));
+	y = _mm_xor_si128(y, _mm_srli_epi32(y, 18));
+	return y;
+}
+
+/*! Temper KERNEL_LANES words, store least significant 8 bits. */
+static inline void vec_temper_uint8(uint8_t *dst, const uint32_t *src)
+{	vec_u32		t;
+	uint32_t	b;
+
+	t = _mm_and_si128(vec_temper(vec_load(src)), _mm_set1_epi32(0xff));
+	t = _mm_packs_epi32(t, t);
+	t = _mm_packus_epi16(t, t);
+	b = (uint32_t)_mm_cvtsi128_si32(t);
+	memcpy(dst, &b, sizeof(b));
+}
+
+/*! Temper KERNEL_LANES words, store as [0,1)-real-interval. */
+static inline void vec_temper_real2(double *dst, const uint32_t *src)
+{	vec_u32		t;
+	__m128d		bias;
+	__m128d		scale;
+
+	/* No unsigned conversion, convert signed (t - 2^31) and add 2^31. */
+	bias = _mm_set1_pd(2147483648.0);
+	scale = _mm_set1_pd(1.0/4294967296.0);
+	t = _mm_xor_si128(vec_temper(vec_load(src)), _mm_set1_epi32((int)UPPER_MASK));
+	_mm_storeu_pd(dst, _mm_mul_pd(_mm_add_pd(_mm_cvtepi32_pd(t), bias), scale));
+	_mm_storeu_pd(dst + 2, _mm_mul_pd(_mm_add_pd(
+		_mm_cvtepi32_pd(_mm_srli_si128(t, 8)), bias), scale)
+	);
+}
+#endif
+
+/*! Regenerate (twist) N words in place.
+    @param mt points the state vector.
+*/
+static void kernel_twist(uint32_t *mt)
+{	int	kk;
+
+	kk = 0;
+#if (KERNEL_LANES > 1)
+	for (; (kk + KERNEL_LANES) <= (N - M); kk += KERNEL_LANES) {
+		vec_store(mt + kk,
+			vec_twist(vec_load(mt + kk), vec_load(mt + kk + 1), vec_load(mt + kk + M))
+		);
+	}
+#endif /* (KERNEL_LANES > 1) */
+	for (; kk < (N - M); kk++) {
+		mt[kk] = twist_word(mt[kk], mt[kk + 1], mt[kk + M]);
+	}
+	/* mt[kk + (M - N)] are already regenerated words. */
+#if (KERNEL_LANES > 1)
+	for (; (kk + KERNEL_LANES) <= (N - 1); kk += KERNEL_LANES) {
+		vec_store(mt + kk,
+			vec_twist(vec_load(mt + kk), vec_load(mt + kk + 1), vec_load(mt + kk + (M - N)))
+		);
+	}
+#endif /* (KERNEL_LANES > 1) */
+	for (; kk < (N - 1); kk++) {
+		mt[kk] = twist_word(mt[kk], mt[kk + 1], mt[kk + (M - N)]);
+	}
+	mt[N - 1] = twist_word(mt[N - 1], mt[0], mt[M - 1]);
+}
+
+/*! Temper n state words into 32 bit random numbers.
+    @param dst points array to store.
+    @param src points state words.
+    @param n the number of words.
+*/
+static void kernel_temper_uint32(uint32_t *dst, const uint32_t *src, size_t n)
+{	size_t	i;
+
+	i = 0;
+#if (KERNEL_LANES > 1)
+	for (; (i + KERNEL_LANES) <= n; i += KERNEL_LANES) {
+		vec_store(dst + i, vec_temper(vec_load(src + i)));
+	}
+#endif /* (KERNEL_LANES > 1) */
+	for (; i < n; i++) {
+		dst[i] = temper_word(src[i]);
+	}
+}
+
+/*! Temper n state words, store least significant 8 bits of each.
+    @param dst points array to store.
+    @param src points state words.
+    @param n the number of words.
+*/
+static void kernel_temper_uint8(uint8_t *dst, const uint32_t *src, size_t n)
+{	size_t	i;
+
+	i = 0;
+#if (KERNEL_LANES > 1)
+	for (; (i + KERNEL_LANES) <= n; i += KERNEL_LANES) {
+		vec_temper_uint8(dst + i, src + i);
+	}
+#endif /* (KERNEL_LANES > 1) */
+	for (; i < n; i++) {
+		dst[i] = (uint8_t)temper_word(src[i]);
+	}
+}
+
+/*! Temper n state words into [0,1)-real-interval numbers.
+    @param dst points array to store.
+    @param src points state words.
+    @param n the number of words.
+*/
+static void kernel_temper_real2(double *dst, const uint32_t *src, size_t n)
+{	size_t	i;
+
+	i = 0;
+#if (KERNEL_LANES > 1)
+	for (; (i + KERNEL_LANES) <= n; i += KERNEL_LANES) {
+		vec_temper_real2(dst + i, src + i);
+	}
+#endif /* (KERNEL_LANES > 1) */
+	for (; i < n; i++) {
+		dst[i] = temper_word(src[i])*(1.0/4294967296.0);
+		/* divided by 2^32 */
+	}
+}
+
+/*! Kernel set of this variant. */
+const mt19937ar_kernel KERNEL_SYMBOL = {
+	.name =			KERNEL_NAME,
+	.twist =		kernel_twist,
+	.temper_uint32 =	kernel_temper_uint32,
+	.temper_uint8 =		kernel_temper_uint8,
+	.temper_real2 =		kernel_temper_real2,
+};
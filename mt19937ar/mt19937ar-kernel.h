@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* MT19937 state regeneration and tempering kernels.
+ * Internal interface between mt19937ar.c and mt19937ar-kernel.c.
+ * mt19937ar-kernel.c is compiled once per ISA variant with
+ * -DMT19937AR_KERNEL_ISA=variant, each object exports its kernel set
+ * as mt19937ar_kernel_variant.
+ */
+#if (!defined(MT19937AR_KERNEL_H))
+#define MT19937AR_KERNEL_H
+#include <stddef.h>
+#include <stdint.h>
+
+/*! Kernel set compiled for one ISA variant. */
+typedef struct mt19937ar_kernel {
+	/*! Variant name, value of MT19937AR_KERNEL environment variable. */
+	const char	*name;
+	/*! Regenerate (twist) MT19937AR_N words in place. */
+	void	(*twist)(uint32_t *mt);
+	/*! Temper n state words into 32 bit random numbers. */
+	void	(*temper_uint32)(uint32_t *dst, const uint32_t *src, size_t n);
+	/*! Temper n state words, store least significant 8 bits of each. */
+	void	(*temper_uint8)(uint8_t *dst, const uint32_t *src, size_t n);
+	/*! Temper n state words into [0,1)-real-interval numbers. */
+	void	(*temper_real2)(double *dst, const uint32_t *src, size_t n);
+} mt19937ar_kernel;
+
+/* Portable variant, always compiled. */
+extern const mt19937ar_kernel mt19937ar_kernel_baseline;
+
+#if (defined(CONFIG_MT19937AR_KERNEL_X86))
+extern const mt19937ar_kernel mt19937ar_kernel_avx2;
+extern const mt19937ar_kernel mt19937ar_kernel_avx512;
+#endif /* (defined(CONFIG_MT19937AR_KERNEL_X86)) */
+
+#endif /* (!defined(MT19937AR_KERNEL_H)) */
@@ -50,24 +50,122 @@
               Akinori Furuta <afuruta@m7.dion.ne.jp>
 */
 
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 #include "mt19937ar.h"
+#include "mt19937ar-kernel.h"
+#include "mt19937-jump.h"
 
 /* Period parameters */
-#define N 624
+#define N MT19937AR_N
 #define M 397
 #define MATRIX_A (uint32_t)(0x9908b0dfUL)   /*!< constant vector a */
 #define UPPER_MASK (uint32_t)(0x80000000UL) /*!< most significant w-r bits */
 #define LOWER_MASK (uint32_t)(0x7fffffffUL) /*!< least significant r bits */
 
-static uint32_t mt[N]; /*!< the array for the state vector  */
-static int mti=N+1; /* mti==N+1 means mt[N] is not initialized */
+/*! the default context, used by non reentrant functions */
+static mt19937ar_ctx genrand_ctx = MT19937AR_CTX_INITIALIZER;
 
-/*! initializes mt[N] with a seed
+/*! Kernel variants, from the most preferred one. */
+static const mt19937ar_kernel *const genrand_kernels[] = {
+#if (defined(CONFIG_MT19937AR_KERNEL_X86))
+    &mt19937ar_kernel_avx512,
+    &mt19937ar_kernel_avx2,
+#endif /* (defined(CONFIG_MT19937AR_KERNEL_X86)) */
+    &mt19937ar_kernel_baseline,
+};
+
+/*! the kernel set in use */
+static const mt19937ar_kernel *genrand_kernel = &mt19937ar_kernel_baseline;
+
+/*! tests the CPU runs kernel variant
+    @param k points kernel variant.
+    @return int non zero if the CPU supports it.
+*/
+static int genrand_kernel_supported(const mt19937ar_kernel *k)
+{
+#if (defined(CONFIG_MT19937AR_KERNEL_X86))
+    __builtin_cpu_init();
+    if (k == &mt19937ar_kernel_avx512)
+        return __builtin_cpu_supports("avx512f");
+    if (k == &mt19937ar_kernel_avx2)
+        return __builtin_cpu_supports("avx2");
+#endif /* (defined(CONFIG_MT19937AR_KERNEL_X86)) */
+    return k == &mt19937ar_kernel_baseline;
+}
+
+/*! selects kernel variant
+    @param name variant name, or NULL to select the fastest one.
+    @return int 0: selected, -1: unknown or not supported variant.
+    @note not thread safe, call before generating numbers.
+*/
+int genrand_kernel_select(const char *name)
+{
+    size_t i;
+    const mt19937ar_kernel *k;
+
+    for (i = 0; i < sizeof(genrand_kernels) / sizeof(genrand_kernels[0]); i++) {
+        k = genrand_kernels[i];
+        if ((name != NULL) && (strcmp(name, k->name) != 0))
+            continue;
+        if (!genrand_kernel_supported(k))
+            continue;
+        genrand_kernel = k;
+        return 0;
+    }
+    return -1;
+}
+
+/*! name of kernel variant in use
+    @return const char * variant name.
+*/
+const char *genrand_kernel_name(void)
+{
+    return genrand_kernel->name;
+}
+
+/*! selects kernel variant at startup
+    @note MT19937AR_KERNEL environment variable forces variant.
+*/
+#if (defined(__GNUC__))
+__attribute__((constructor))
+#endif /* (defined(__GNUC__)) */
+static void genrand_kernel_startup(void)
+{
+    const char *name;
+
+    name = getenv("MT19937AR_KERNEL");
+    if ((name != NULL) && (*name != '\0')) {
+        if (genrand_kernel_select(name) == 0)
+            return;
+        fprintf(stderr, "%s: Warning: MT19937AR_KERNEL=%s is unknown "
+                "or not supported, auto select.\n"
+               , __func__, name
+        );
+    }
+    genrand_kernel_select(NULL);
+}
+
+/*! makes context "not initialized"
+    @param ctx points context.
+    @note the 1st draw from ctx seeds it with 5489.
+*/
+void mt19937ar_ctx_init(mt19937ar_ctx *ctx)
+{
+    ctx->mti = N+1;
+}
+
+/*! initializes ctx->mt[N] with a seed
+    @param ctx points context.
     @param s random seed.
 */
-void init_genrand(uint32_t s)
+void init_genrand_r(mt19937ar_ctx *ctx, uint32_t s)
 {
+    uint32_t *mt = ctx->mt;
+    int mti;
+
     mt[0]= s;
     for (mti=1; mti<N; mti++) {
         mt[mti] =
@@ -77,17 +175,20 @@ void init_genrand(uint32_t s)
         /* only MSBs of the array mt[].                        */
         /* 2002/01/09 modified by Makoto Matsumoto             */
     }
+    ctx->mti = mti;
 }
 
-/*! initialize by an array with array-length
+/*! initialize ctx by an array with array-length
+    @param ctx points context.
     @param init_key points the array for initializing keys.
     @param  key_length the number of elements in array pointed by init_key
     @note   slight change for C++, 2004/2/26
 */
-void init_by_array(uint32_t init_key[], int key_length)
+void init_by_array_r(mt19937ar_ctx *ctx, uint32_t init_key[], int key_length)
 {
+    uint32_t *mt = ctx->mt;
     int i, j, k;
-    init_genrand((uint32_t)(19650218UL));
+    init_genrand_r(ctx, (uint32_t)(19650218UL));
     if (key_length<0) {
         printf("%s: Warning: key_length should be "
                "grater than zero. key_length=%d\n"
@@ -114,59 +215,373 @@ void init_by_array(uint32_t init_key[], int key_length)
     mt[0] = 0x80000000UL; /* MSB is 1; assuring non-zero initial array */
 }
 
-/*! generates a random number on [0,0xffffffff]-interval
+/*! generates N words at one time into ctx->mt[]
+    @param ctx points context.
+*/
+static void genrand_next_state(mt19937ar_ctx *ctx)
+{
+    if (ctx->mti == N+1)   /* if init_genrand() has not been called, */
+        init_genrand_r(ctx, (uint32_t)(5489UL)); /* a default initial seed is used */
+
+    genrand_kernel->twist(ctx->mt);
+
+    ctx->mti = 0;
+}
+
+/*! tempers a state word
+    @param y state word.
+    @return uint32_t tempered word.
+*/
+static inline uint32_t genrand_temper(uint32_t y)
+{
+    y ^= (y >> 11);
+    y ^= (y << 7) & 0x9d2c5680UL;
+    y ^= (y << 15) & 0xefc60000UL;
+    y ^= (y >> 18);
+
+    return y;
+}
+
+/*! generates a random number on [0,0xffffffff]-interval from ctx
+    @param ctx points context.
     @return uint32_t generated random number.
 */
-uint32_t genrand_uint32(void)
+uint32_t genrand_uint32_r(mt19937ar_ctx *ctx)
+{
+    if (ctx->mti >= N) { /* generate N words at one time */
+        genrand_next_state(ctx);
+    }
+
+    return genrand_temper(ctx->mt[ctx->mti++]);
+}
+
+/*! fills array with random numbers on [0,0xffffffff]-interval from ctx
+    @param ctx points context.
+    @param dst points array to fill.
+    @param n the number of elements to fill.
+    @note dst[] is same sequence as calling genrand_uint32_r() n times.
+*/
+void genrand_fill_uint32(mt19937ar_ctx *ctx, uint32_t *dst, size_t n)
+{
+    size_t m;
+
+    while (n) {
+        if (ctx->mti >= N) {
+            genrand_next_state(ctx);
+        }
+        m = N - ctx->mti;
+        if (m > n) {
+            m = n;
+        }
+        genrand_kernel->temper_uint32(dst, &(ctx->mt[ctx->mti]), m);
+        ctx->mti += (int)m;
+        dst += m;
+        n -= m;
+    }
+}
+
+/*! fills array with least significant 8 bits of random numbers from ctx
+    @param ctx points context.
+    @param dst points array to fill.
+    @param n the number of bytes to fill.
+    @note dst[i] is (uint8_t)genrand_uint32_r(ctx) of i-th call.
+*/
+void genrand_fill_uint8(mt19937ar_ctx *ctx, uint8_t *dst, size_t n)
+{
+    size_t m;
+
+    while (n) {
+        if (ctx->mti >= N) {
+            genrand_next_state(ctx);
+        }
+        m = N - ctx->mti;
+        if (m > n) {
+            m = n;
+        }
+        genrand_kernel->temper_uint8(dst, &(ctx->mt[ctx->mti]), m);
+        ctx->mti += (int)m;
+        dst += m;
+        n -= m;
+    }
+}
+
+/*! fills array with random numbers on [0,1)-real-interval from ctx
+    @param ctx points context.
+    @param dst points array to fill.
+    @param n the number of elements to fill.
+    @note dst[] is same sequence as calling genrand_real2_r() n times.
+*/
+void genrand_fill_real2(mt19937ar_ctx *ctx, double *dst, size_t n)
+{
+    size_t m;
+
+    while (n) {
+        if (ctx->mti >= N) {
+            genrand_next_state(ctx);
+        }
+        m = N - ctx->mti;
+        if (m > n) {
+            m = n;
+        }
+        genrand_kernel->temper_real2(dst, &(ctx->mt[ctx->mti]), m);
+        ctx->mti += (int)m;
+        dst += m;
+        n -= m;
+    }
+}
+
+/*! generates a random number on [0,0x7fffffff]-interval from ctx
+    @param ctx points context.
+    @return int32_t generated random number.
+*/
+int32_t genrand_int31_r(mt19937ar_ctx *ctx)
+{
+    return (int32_t)(genrand_uint32_r(ctx)>>1);
+}
+
+/*! generates a random number on [0,1]-real-interval from ctx
+    @param ctx points context.
+    @return double generated random number.
+*/
+double genrand_real1_r(mt19937ar_ctx *ctx)
+{
+    return genrand_uint32_r(ctx)*(1.0/4294967295.0);
+    /* divided by 2^32-1 */
+}
+
+/*! generates a random number on [0,1)-real-interval from ctx
+    @param ctx points context.
+    @return double generated random number.
+*/
+double genrand_real2_r(mt19937ar_ctx *ctx)
+{
+    return genrand_uint32_r(ctx)*(1.0/4294967296.0);
+    /* divided by 2^32 */
+}
+
+/*! generates a random number on (0,1)-real-interval from ctx
+    @param ctx points context.
+    @return double generated random number.
+*/
+double genrand_real3_r(mt19937ar_ctx *ctx)
+{
+    return (((double)genrand_uint32_r(ctx)) + 0.5)*(1.0/4294967296.0);
+    /* divided by 2^32 */
+}
+
+/*! generates a random number on [0,1) with 53-bit resolution from ctx
+    @param ctx points context.
+    @return double generated random number.
+*/
+double genrand_res53_r(mt19937ar_ctx *ctx)
+{
+    uint32_t a=genrand_uint32_r(ctx)>>5, b=genrand_uint32_r(ctx)>>6;
+    return(a*67108864.0+b)*(1.0/9007199254740992.0);
+}
+/* These real versions are due to Isaku Wada, 2002/01/09 added */
+
+/* Jump ahead.
+   The state moves by a linear map A over GF(2), and
+   A^k = q(A) where q(x) = x^k mod phi(x), phi(x) is the characteristic
+   polynomial of A. So the state k words ahead is the sum of states
+   0 .. deg(q) words ahead weighted by coefficients of q(x), evaluated
+   by Horner's method. Each step of the evaluation costs one word of
+   regeneration on a ring of N words, cheaper than generating k words
+   when k is large.
+   See H. Haramoto, M. Matsumoto, T. Nishimura, F. Panneton,
+   P. L'Ecuyer, "Efficient Jump Ahead for F2-Linear Random Number
+   Generators", INFORMS Journal on Computing, 2008.
+*/
+
+#define JUMP_MEXP MT19937_JUMP_MEXP /*!< degree of phi(x), Mersenne exponent */
+#define JUMP_POLY_BITS_WORD (64)
+
+/*! exponents of terms of phi(x) lower than x^JUMP_MEXP.
+    @note phi(x) is the minimal polynomial of output sequence,
+          computed by Berlekamp-Massey algorithm from 2*JUMP_MEXP
+          outputs. It has 135 terms including x^JUMP_MEXP.
+*/
+static const uint16_t genrand_jump_phi_terms[] = {
+        0,  1189,  1416,  1585,  1643,  1870,  2493,  2773,
+     3000,  3227,  3454,  3681,  3908,  4135,  4362,  4753,
+     5661,  6337,  6569,  7129,  7477,  7525,  7583,  7752,
+     7979,  8206,  9505,  9901,  9969, 10128, 10693, 10761,
+    10920, 11089, 11147, 11157, 11215, 11321, 11374, 11384,
+    11485, 11611, 11712, 11717, 11838, 11881, 11944, 11997,
+    12277, 12335, 12393, 12504, 12509, 12620, 12673, 12731,
+    12736, 12789, 12905, 12958, 12963, 13137, 13185, 13190,
+    13243, 13301, 13412, 13528, 13533, 13639, 13697, 13760,
+    13813, 13866, 14093, 14151, 14209, 14320, 14325, 14436,
+    14547, 14552, 14605, 14721, 14774, 14779, 14953, 15001,
+    15006, 15059, 15117, 15228, 15344, 15349, 15455, 15513,
+    15576, 15629, 15682, 15909, 15967, 16025, 16136, 16141,
+    16252, 16363, 16368, 16421, 16537, 16590, 16595, 16817,
+    16822, 16875, 16933, 17044, 17160, 17271, 17329, 17445,
+    17498, 17725, 17783, 17841, 17952, 18068, 18179, 18237,
+    18406, 18633, 18691, 18860, 19087, 19314
+};
+
+/*! prepares jump ahead by words
+    @param jp points jump to prepare.
+    @param words the number of words to jump ahead.
+    @note jp can be applied to any number of contexts.
+*/
+void genrand_jump_prepare(mt19937ar_jump *jp, uint64_t words)
+{
+    jp->words = words;
+    memset(jp->poly, 0, sizeof(jp->poly));
+    if ((words / N) > MT19937AR_JUMP_DIRECT_BLOCKS) {
+        mt19937_jump_pow_x(jp->poly, MT19937AR_JUMP_POLY_WORDS, (words / N) * N,
+            genrand_jump_phi_terms,
+            sizeof(genrand_jump_phi_terms) / sizeof(genrand_jump_phi_terms[0]));
+    }
+}
+
+/*! regenerates one word on the ring state
+    @param ring points ring of N words.
+    @param i index of the oldest word, replaced with new word.
+*/
+static inline void jump_ring_next(uint32_t *ring, int i)
 {
     uint32_t y;
+    int i1 = i + 1;
+    int im = i + M;
+
+    if (i1 >= N) i1 -= N;
+    if (im >= N) im -= N;
+    y = (ring[i]&UPPER_MASK)|(ring[i1]&LOWER_MASK);
+    ring[i] = ring[im] ^ (y >> 1) ^ ((y & 0x1UL) ? MATRIX_A : 0x0UL);
+}
 
-#if (!defined(CONFIG_2SCOMP))
-    static const uint32_t mag01[2]={0x0UL, MATRIX_A};
-#endif /* (!defined(CONFIG_2SCOMP)) */
-    /* mag01[x] = x * MATRIX_A  for x=0,1 */
+#if (!defined(JUMP_WINDOW))
+#define JUMP_WINDOW (4) /*!< coefficients of poly(x) added at once, divides 64 */
+#endif
 
-    if (mti >= N) { /* generate N words at one time */
-        int kk;
+/*! moves block aligned state ahead by poly(A)
+    @param mt points state vector, regenerated block.
+    @param poly points jump polynomial.
+    @note Horner's method steps JUMP_WINDOW coefficients at once,
+          adds one of precomputed sums of mt .. A^(JUMP_WINDOW-1) mt.
+*/
+static void jump_horner(uint32_t *mt, const uint64_t *poly)
+{
+    uint32_t acc[N];
+    uint32_t table[1 << JUMP_WINDOW][N];
+    uint64_t h;
+    int deg, d, i, j, k;
 
-        if (mti == N+1)   /* if init_genrand() has not been called, */
-            init_genrand((uint32_t)(5489UL)); /* a default initial seed is used */
+    for (deg = JUMP_MEXP - 1; deg >= 0; deg--) {
+        if ((poly[deg / JUMP_POLY_BITS_WORD] >> (deg % JUMP_POLY_BITS_WORD)) & 0x1)
+            break;
+    }
 
-        for (kk=0;kk<N-M;kk++) {
-            y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
-#if (defined(CONFIG_2SCOMP))
-            mt[kk] = mt[kk+M] ^ ((uint32_t)(0-(y & 0x1UL)) & MATRIX_A) ^ (y >> 1);
-#else /* (defined(CONFIG_2SCOMP)) */
-            mt[kk] = mt[kk+M] ^ (y >> 1) ^ mag01[y & 0x1UL];
-#endif /* (defined(CONFIG_2SCOMP)) */
+    /* table[k] = sum of A^j mt for bit j of k, in linear order. */
+    memcpy(acc, mt, sizeof(acc));
+    memset(table[0], 0, sizeof(table[0]));
+    for (j = 0; j < JUMP_WINDOW; j++) {
+        for (k = 0; k < N; k++)
+            table[1 << j][k] = acc[(j + k) % N];
+        for (k = 1; k < (1 << j); k++) {
+            for (i = 0; i < N; i++)
+                table[(1 << j) + k][i] = table[1 << j][i] ^ table[k][i];
         }
-        for (;kk<N-1;kk++) {
-            y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
-#if (defined(CONFIG_2SCOMP))
-            mt[kk] = mt[kk+(M-N)] ^ ((uint32_t)(0-(y & 0x1UL)) & MATRIX_A) ^ (y >> 1);
-#else /* (defined(CONFIG_2SCOMP)) */
-            mt[kk] = mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & 0x1UL];
-#endif /* (defined(CONFIG_2SCOMP)) */
+        jump_ring_next(acc, j);
+    }
+
+    memset(acc, 0, sizeof(acc));
+    i = 0;
+    for (d = deg - (deg % JUMP_WINDOW); d >= 0; d -= JUMP_WINDOW) {
+        /* acc = A^JUMP_WINDOW acc */
+        for (k = 0; k < JUMP_WINDOW; k++) {
+            jump_ring_next(acc, i);
+            i++;
+            if (i >= N) i = 0;
         }
-        y = (mt[N-1]&UPPER_MASK)|(mt[0]&LOWER_MASK);
-#if (defined(CONFIG_2SCOMP))
-        mt[N-1] = mt[M-1] ^ ((uint32_t)(0-(y & 0x1UL)) & MATRIX_A) ^ (y >> 1);
-#else /* (defined(CONFIG_2SCOMP)) */
-        mt[N-1] = mt[M-1] ^ (y >> 1) ^ mag01[y & 0x1UL];
-#endif /* (defined(CONFIG_2SCOMP)) */
+        /* d is multiple of JUMP_WINDOW, window is in a word. */
+        h = (poly[d / JUMP_POLY_BITS_WORD] >> (d % JUMP_POLY_BITS_WORD))
+            & ((1 << JUMP_WINDOW) - 1);
+        if (h) {
+            /* acc += table[h] */
+            for (j = 0; j < (N - i); j++)
+                acc[i + j] ^= table[h][j];
+            for (; j < N; j++)
+                acc[i + j - N] ^= table[h][j];
+        }
+    }
+    for (j = 0; j < (N - i); j++)
+        mt[j] = acc[i + j];
+    for (; j < N; j++)
+        mt[j] = acc[i + j - N];
+}
+
+/*! jumps ahead ctx by prepared jump
+    @param ctx points context.
+    @param jp points prepared jump.
+    @note after jump, ctx generates the same numbers as skipping
+          jp->words numbers by genrand_uint32_r().
+*/
+void genrand_jump_apply_r(mt19937ar_ctx *ctx, const mt19937ar_jump *jp)
+{
+    uint64_t blocks;
+    int rest;
 
-        mti = 0;
+    if (ctx->mti >= N) {
+        /* Start from regenerated block, all words follow recurrence. */
+        genrand_next_state(ctx);
     }
 
-    y = mt[mti++];
+    blocks = jp->words / N;
+    rest = (int)(jp->words % N);
+    if (blocks > MT19937AR_JUMP_DIRECT_BLOCKS) {
+        jump_horner(ctx->mt, jp->poly);
+    } else {
+        for (; blocks > 0; blocks--)
+            genrand_kernel->twist(ctx->mt);
+    }
 
-    /* Tempering */
-    y ^= (y >> 11);
-    y ^= (y << 7) & 0x9d2c5680UL;
-    y ^= (y << 15) & 0xefc60000UL;
-    y ^= (y >> 18);
+    ctx->mti += rest;
+    if (ctx->mti >= N) {
+        ctx->mti -= N;
+        genrand_kernel->twist(ctx->mt);
+    }
+}
 
-    return y;
+/*! jumps ahead ctx by words
+    @param ctx points context.
+    @param words the number of words to jump ahead.
+*/
+void genrand_jump_r(mt19937ar_ctx *ctx, uint64_t words)
+{
+    mt19937ar_jump jp;
+
+    genrand_jump_prepare(&jp, words);
+    genrand_jump_apply_r(ctx, &jp);
+}
+
+/*! initializes mt[N] with a seed
+    @param s random seed.
+*/
+void init_genrand(uint32_t s)
+{
+    init_genrand_r(&genrand_ctx, s);
+}
+
+/*! initialize by an array with array-length
+    @param init_key points the array for initializing keys.
+    @param  key_length the number of elements in array pointed by init_key
+    @note   slight change for C++, 2004/2/26
+*/
+void init_by_array(uint32_t init_key[], int key_length)
+{
+    init_by_array_r(&genrand_ctx, init_key, key_length);
+}
+
+/*! generates a random number on [0,0xffffffff]-interval
+    @return uint32_t generated random number.
+*/
+uint32_t genrand_uint32(void)
+{
+    return genrand_uint32_r(&genrand_ctx);
 }
 
 /*! generates a random number on [0,0x7fffffff]-interval
@@ -174,7 +589,7 @@ uint32_t genrand_uint32(void)
 */
 int32_t genrand_int31(void)
 {
-    return (int32_t)(genrand_uint32()>>1);
+    return genrand_int31_r(&genrand_ctx);
 }
 
 /*! generates a random number on [0,1]-real-interval
@@ -182,8 +597,7 @@ int32_t genrand_int31(void)
 */
 double genrand_real1(void)
 {
-    return genrand_uint32()*(1.0/4294967295.0);
-    /* divided by 2^32-1 */
+    return genrand_real1_r(&genrand_ctx);
 }
 
 /*! generates a random number on [0,1)-real-interval
@@ -191,8 +605,7 @@ double genrand_real1(void)
 */
 double genrand_real2(void)
 {
-    return genrand_uint32()*(1.0/4294967296.0);
-    /* divided by 2^32 */
+    return genrand_real2_r(&genrand_ctx);
 }
 
 /*! generates a random number on (0,1)-real-interval
@@ -200,8 +613,7 @@ double genrand_real2(void)
 */
 double genrand_real3(void)
 {
-    return (((double)genrand_uint32()) + 0.5)*(1.0/4294967296.0);
-    /* divided by 2^32 */
+    return genrand_real3_r(&genrand_ctx);
 }
 
 /*! generates a random number on [0,1) with 53-bit resolution
@@ -209,7 +621,13 @@ double genrand_real3(void)
 */
 double genrand_res53(void)
 {
-    uint32_t a=genrand_uint32()>>5, b=genrand_uint32()>>6;
-    return(a*67108864.0+b)*(1.0/9007199254740992.0);
+    return genrand_res53_r(&genrand_ctx);
+}
+
+/*! jumps ahead by words
+    @param words the number of words to jump ahead.
+*/
+void genrand_jump(uint64_t words)
+{
+    genrand_jump_r(&genrand_ctx, words);
 }
-/* These real versions are due to Isaku Wada, 2002/01/09 added */
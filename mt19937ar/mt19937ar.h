@@ -49,9 +49,107 @@
               Akinori Furuta <afuruta@m7.dion.ne.jp>
 */
 
+#if (!defined(MT19937AR_H))
+#define MT19937AR_H
+
+#include <stddef.h>
 #include <stdint.h>
 #include <inttypes.h>
 
+/* Period parameters */
+#define MT19937AR_N	(624)	/*!< the number of words in the state vector */
+
+#if (defined(__GNUC__))
+#define MT19937AR_CACHE_ALIGNED	__attribute__((aligned(64)))
+#else
+#define MT19937AR_CACHE_ALIGNED
+#endif /* (defined(__GNUC__)) */
+
+/*! MT19937 generator state (context).
+    @note Each thread should own its context. The context is aligned
+          to a cache line, so contexts never share a cache line.
+*/
+typedef struct mt19937ar_ctx {
+    uint32_t mt[MT19937AR_N]; /*!< the array for the state vector  */
+    int mti; /*!< mti==N+1 means mt[N] is not initialized */
+} MT19937AR_CACHE_ALIGNED mt19937ar_ctx;
+
+/*! Static initializer of not seeded context. */
+#define MT19937AR_CTX_INITIALIZER { .mti = MT19937AR_N + 1 }
+
+/* makes ctx "not initialized", the 1st draw seeds it with 5489 */
+void mt19937ar_ctx_init(mt19937ar_ctx *ctx);
+
+/* initializes ctx->mt[N] with a seed */
+void init_genrand_r(mt19937ar_ctx *ctx, uint32_t s);
+
+/* initialize ctx by an array with array-length */
+void init_by_array_r(mt19937ar_ctx *ctx, uint32_t init_key[], int key_length);
+
+/* generates a random number on [0,0xffffffff]-interval from ctx */
+uint32_t genrand_uint32_r(mt19937ar_ctx *ctx);
+
+/* generates a random number on [0,0x7fffffff]-interval from ctx */
+int32_t genrand_int31_r(mt19937ar_ctx *ctx);
+
+/* generates a random number on [0,1]-real-interval from ctx */
+double genrand_real1_r(mt19937ar_ctx *ctx);
+
+/* generates a random number on [0,1)-real-interval from ctx */
+double genrand_real2_r(mt19937ar_ctx *ctx);
+
+/* generates a random number on (0,1)-real-interval from ctx */
+double genrand_real3_r(mt19937ar_ctx *ctx);
+
+/* generates a random number on [0,1) with 53-bit resolution from ctx */
+double genrand_res53_r(mt19937ar_ctx *ctx);
+
+/* Bulk fill functions, produce the same sequence as calling */
+/* corresponding single number function n times. */
+
+/* fills dst[n] with random numbers on [0,0xffffffff]-interval */
+void genrand_fill_uint32(mt19937ar_ctx *ctx, uint32_t *dst, size_t n);
+
+/* fills dst[n] with least significant 8 bits of random numbers */
+void genrand_fill_uint8(mt19937ar_ctx *ctx, uint8_t *dst, size_t n);
+
+/* fills dst[n] with random numbers on [0,1)-real-interval */
+void genrand_fill_real2(mt19937ar_ctx *ctx, double *dst, size_t n);
+
+/* Jump ahead functions. */
+
+/*! the number of 64 bit words holding jump polynomial */
+#define MT19937AR_JUMP_POLY_WORDS	(312)
+/*! jumps up to this number of blocks (N words) regenerate directly */
+#define MT19937AR_JUMP_DIRECT_BLOCKS	(8192)
+
+/*! Prepared jump, x^(N * floor(words / N)) mod phi(x) */
+typedef struct mt19937ar_jump {
+    uint64_t words; /*!< the number of words to jump ahead */
+    uint64_t poly[MT19937AR_JUMP_POLY_WORDS]; /*!< jump polynomial */
+} mt19937ar_jump;
+
+/* prepares jump ahead by words, may be applied to many contexts */
+void genrand_jump_prepare(mt19937ar_jump *jp, uint64_t words);
+
+/* jumps ahead ctx by prepared jump */
+void genrand_jump_apply_r(mt19937ar_ctx *ctx, const mt19937ar_jump *jp);
+
+/* jumps ahead ctx by words, same as skipping words numbers */
+void genrand_jump_r(mt19937ar_ctx *ctx, uint64_t words);
+
+/* Kernel (regeneration and tempering) ISA variant selection. */
+/* A variant is selected at startup, MT19937AR_KERNEL environment */
+/* variable forces one of "baseline", "avx2", "avx512". */
+
+/* selects kernel variant by name, NULL selects the fastest one */
+int genrand_kernel_select(const char *name);
+
+/* name of kernel variant in use */
+const char *genrand_kernel_name(void);
+
+/* Following functions use the default (process global) context. */
+
 /* initializes mt[N] with a seed */
 void init_genrand(uint32_t s);
 
@@ -79,3 +177,8 @@ double genrand_real3(void);
 
 /* generates a random number on [0,1) with 53-bit resolution*/
 double genrand_res53(void);
+
+/* jumps ahead by words, same as skipping words numbers */
+void genrand_jump(uint64_t words);
+
+#endif /* (!defined(MT19937AR_H)) */
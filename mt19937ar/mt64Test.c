@@ -0,0 +1,214 @@
+/*
+   A C-program for MT19937-64 (2004/9/29 version).
+   Coded by Takuji Nishimura and Makoto Matsumoto.
+
+   This is a 64-bit version of Mersenne Twister pseudorandom number
+   generator.
+
+   Before using, initialize the state by using init_genrand64(seed)
+   or init_by_array64(init_key, key_length).
+
+   Copyright (C) 2004, Makoto Matsumoto and Takuji Nishimura,
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+     1. Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+     2. Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+     3. The names of its contributors may not be used to endorse or promote
+        products derived from this software without specific prior written
+        permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+   References:
+   T. Nishimura, ``Tables of 64-bit Mersenne Twisters''
+     ACM Transactions on Modeling and
+     Computer Simulation 10. (2000) 348--357.
+   M. Matsumoto and T. Nishimura,
+     ``Mersenne Twister: a 623-dimensionally equidistributed
+       uniform pseudorandom number generator''
+     ACM Transactions on Modeling and
+     Computer Simulation 8. (Jan. 1998) 3--30.
+
+   Any feedback is very welcome.
+   http://www.math.hiroshima-u.ac.jp/~m-mat/MT/emt.html
+   email: m-mat @ math.sci.hiroshima-u.ac.jp (remove spaces)
+*/
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "mt19937-64.h"
+
+#define OUTPUTS (1000)
+
+/* Chunk lengths to call bulk fill functions, crossing NN boundaries. */
+static const size_t fill_chunks[] = {1, 7, 311, 2, 312, 313, 5, 625};
+
+/* Fill array by bulk fill function in various chunk lengths. */
+static void fill_uint64_chunks(mt19937_64_ctx *ctx, uint64_t *dst, size_t n)
+{
+    size_t c = 0;
+    size_t m;
+
+    while (n) {
+        m = fill_chunks[c % (sizeof(fill_chunks) / sizeof(fill_chunks[0]))];
+        if (m > n) m = n;
+        genrand64_fill_uint64(ctx, dst, m);
+        dst += m; n -= m; c++;
+    }
+}
+
+static void fill_real2_chunks(mt19937_64_ctx *ctx, double *dst, size_t n)
+{
+    size_t c = 0;
+    size_t m;
+
+    while (n) {
+        m = fill_chunks[c % (sizeof(fill_chunks) / sizeof(fill_chunks[0]))];
+        if (m > n) m = n;
+        genrand64_fill_real2(ctx, dst, m);
+        dst += m; n -= m; c++;
+    }
+}
+
+/* Test bulk fill functions, print same format as sequential test. */
+static int bulk_test(uint64_t init[], uint64_t length)
+{
+    static mt19937_64_ctx ctx;
+    static mt19937_64_ctx ctx8;
+    static mt19937_64_ctx skip;
+    static uint64_t u64[OUTPUTS];
+    static uint8_t u8[OUTPUTS];
+    static double r2[OUTPUTS];
+    int result = 0;
+    int i;
+
+    init_by_array64_r(&ctx, init, length);
+    init_by_array64_r(&ctx8, init, length);
+    init_by_array64_r(&skip, init, length);
+    fill_uint64_chunks(&ctx, u64, OUTPUTS);
+    fill_real2_chunks(&ctx, r2, OUTPUTS);
+    genrand64_fill_uint8(&ctx8, u8, sizeof(u8));
+    for (i=0; i<OUTPUTS; i++) {
+      if (u8[i] != (uint8_t)u64[i]) {
+        fprintf(stderr, "genrand64_fill_uint8(): Mismatch at %d\n", i);
+        result = 1;
+        break;
+      }
+    }
+    genrand64_discard_r(&skip, OUTPUTS + 1);
+    if ((uint64_t)(genrand64_real2_r(&skip) * 9007199254740992.0) !=
+        (uint64_t)(r2[1] * 9007199254740992.0)) {
+      fprintf(stderr, "genrand64_discard_r(): Mismatch\n");
+      result = 1;
+    }
+    printf("1000 outputs of genrand64_int64()\n");
+    for (i=0; i<OUTPUTS; i++) {
+      printf("%20" PRIu64 " ", u64[i]);
+      if (i%5==4) printf("\n");
+    }
+    printf("\n1000 outputs of genrand64_real2()\n");
+    for (i=0; i<OUTPUTS; i++) {
+      printf("%10.8f ", r2[i]);
+      if (i%5==4) printf("\n");
+    }
+    return result;
+}
+
+/* Jump distances to test, around block boundaries and direct
+   regeneration threshold. */
+static const uint64_t jump_words[] = {
+    0, 1, 311, 312, 313, 1000,
+    (uint64_t)MT19937_64_NN * MT19937_64_JUMP_DIRECT_BLOCKS + 1,
+    (uint64_t)MT19937_64_NN * (MT19937_64_JUMP_DIRECT_BLOCKS + 1),
+    (uint64_t)MT19937_64_NN * (MT19937_64_JUMP_DIRECT_BLOCKS + 1) + 311,
+    12345678, 100000007,
+};
+
+/* Test jump ahead, compare to skipping numbers sequentially. */
+static int jump_test(uint64_t init[], uint64_t length)
+{
+    static mt19937_64_ctx seq;
+    static mt19937_64_ctx jmp;
+    static mt19937_64_jump jp;
+    static uint64_t skip[MT19937_64_NN * 16];
+    uint64_t n;
+    uint64_t m;
+    size_t i;
+    int k;
+    int result = 0;
+
+    for (i = 0; i < sizeof(jump_words) / sizeof(jump_words[0]); i++) {
+      /* Start from the middle of a block, then at the block end. */
+      for (k = 0; k < 2; k++) {
+        init_by_array64_r(&seq, init, length);
+        genrand64_fill_uint64(&seq, skip, (k == 0) ? 100 : MT19937_64_NN);
+        jmp = seq;
+
+        genrand64_jump_prepare(&jp, jump_words[i]);
+        genrand64_jump_apply_r(&jmp, &jp);
+        for (n = jump_words[i]; n; n -= m) {
+          m = (n < (sizeof(skip) / sizeof(skip[0]))) ? n : (sizeof(skip) / sizeof(skip[0]));
+          genrand64_fill_uint64(&seq, skip, (size_t)m);
+        }
+        for (n = 0; n < 2 * MT19937_64_NN; n++) {
+          if (genrand64_uint64_r(&seq) != genrand64_uint64_r(&jmp)) {
+            fprintf(stderr, "jump %" PRIu64 " words: Mismatch at %" PRIu64 "\n",
+                jump_words[i], n);
+            result = 1;
+            break;
+          }
+        }
+      }
+    }
+    return result;
+}
+
+/* mt64Test: Sequential test.
+   mt64Test -b: Bulk fill test.
+   mt64Test -j: Jump ahead test.
+*/
+int main(int argc, char **argv)
+{
+    int i;
+    uint64_t init[4]={0x12345ULL, 0x23456ULL, 0x34567ULL, 0x45678ULL};
+    uint64_t length=4;
+    if ((argc > 1) && (strcmp(argv[1], "-b") == 0)) {
+      return bulk_test(init, length);
+    }
+    if ((argc > 1) && (strcmp(argv[1], "-j") == 0)) {
+      return jump_test(init, length);
+    }
+    init_by_array64(init, length);
+    printf("1000 outputs of genrand64_int64()\n");
+    for (i=0; i<1000; i++) {
+      printf("%20" PRIu64 " ", genrand64_uint64());
+      if (i%5==4) printf("\n");
+    }
+    printf("\n1000 outputs of genrand64_real2()\n");
+    for (i=0; i<1000; i++) {
+      printf("%10.8f ", genrand64_real2());
+      if (i%5==4) printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,468 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* Micro benchmark of pseudo random number generator library.
+ * Checks outputs against the golden file (mt19937ar.out) at first,
+ * then reports ns/word and GB/s of each function, kernel ISA variant
+ * and engine, and ns/jump of jump ahead.
+ */
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include "mt19937ar.h"
+#include "mt19937-64.h"
+#include "prng-engine.h"
+
+#define	ElementsOf(array)	((sizeof(array)) / (sizeof((array)[0])))
+
+/*! Words per timed batch. */
+#define	BENCH_BATCH_WORDS	(1024 * 1024)
+
+/*! Default minimum time to measure each item, in seconds. */
+#define	BENCH_MIN_SECONDS	(0.25)
+
+/*! Distance of each measured jump ahead, in words. */
+#define	BENCH_JUMP_WORDS	(UINT64_C(1) << 30)
+
+/*! Words in golden file, per section. */
+#define	GOLDEN_OUTPUTS		(1000)
+
+/* Error output file pointer.
+ */
+FILE	*fpError = NULL;
+
+const char HelpMessage[] =
+	"%s: HELP: Benchmark pseudo random number generator library.\n"
+	"%s: HELP: mtBench [-t seconds] [golden_file]\n"
+	"%s: HELP: -t seconds: Minimum time to measure each function (default %.2f).\n"
+	"%s: HELP: golden_file: Pre calculated output, mt19937ar.out.\n"
+	"%s: HELP:   Checks outputs of each kernel variant before measuring.\n"
+	;
+
+/*! Sink of generated values, keeps compiler from removing loops. */
+volatile uint64_t	BenchSink;
+
+static uint32_t		BenchU32[BENCH_BATCH_WORDS];
+static uint64_t		BenchU64[BENCH_BATCH_WORDS];
+static uint8_t		BenchU8[BENCH_BATCH_WORDS];
+static double		BenchReal[BENCH_BATCH_WORDS];
+
+static mt19937ar_ctx	BenchCtx = MT19937AR_CTX_INITIALIZER;
+static mt19937_64_ctx	BenchCtx64 = MT19937_64_CTX_INITIALIZER;
+static PrngEngine	BenchEngine;
+
+/*! Key of golden output. */
+static uint32_t		GoldenKey[4] = {0x123, 0x234, 0x345, 0x456};
+
+/*! Benchmark item, runs words words once. */
+typedef struct {
+	const char	*Name;		/*!< Function name. */
+	size_t		WordBytes;	/*!< Bytes of output per word. */
+	unsigned int	Scale;		/*!< Words processed per requested word. */
+	void		(*Run)(size_t words);
+} BenchItem;
+
+static double Now(void)
+{	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)(ts.tv_sec) + (double)(ts.tv_nsec) * 1e-9;
+}
+
+/* Per call functions. */
+
+static void RunGenrandUint32(size_t words)
+{	uint32_t	x = 0;
+	size_t		i;
+
+	for (i = 0; i < words; i++) {
+		x ^= genrand_uint32_r(&BenchCtx);
+	}
+	BenchSink ^= x;
+}
+
+static void RunGenrandReal2(size_t words)
+{	double	x = 0.0;
+	size_t	i;
+
+	for (i = 0; i < words; i++) {
+		x += genrand_real2_r(&BenchCtx);
+	}
+	BenchSink ^= (uint64_t)x;
+}
+
+static void RunGenrandRes53(size_t words)
+{	double	x = 0.0;
+	size_t	i;
+
+	for (i = 0; i < words; i++) {
+		x += genrand_res53_r(&BenchCtx);
+	}
+	BenchSink ^= (uint64_t)x;
+}
+
+/* Initializers, a word is a state word. */
+
+static void RunInitGenrand(size_t words)
+{	size_t	i;
+
+	for (i = 0; i < words; i += MT19937AR_N) {
+		init_genrand_r(&BenchCtx, (uint32_t)i);
+	}
+	BenchSink ^= BenchCtx.mt[MT19937AR_N - 1];
+}
+
+static void RunInitByArray(size_t words)
+{	size_t	i;
+
+	for (i = 0; i < words; i += MT19937AR_N) {
+		GoldenKey[0] = (uint32_t)i;
+		init_by_array_r(&BenchCtx, GoldenKey, ElementsOf(GoldenKey));
+	}
+	GoldenKey[0] = 0x123;
+	BenchSink ^= BenchCtx.mt[MT19937AR_N - 1];
+}
+
+/* Bulk fill functions. */
+
+static void RunFillUint32(size_t words)
+{	genrand_fill_uint32(&BenchCtx, BenchU32, words);
+	BenchSink ^= BenchU32[words - 1];
+}
+
+static void RunFillUint8(size_t words)
+{	genrand_fill_uint8(&BenchCtx, BenchU8, words);
+	BenchSink ^= BenchU8[words - 1];
+}
+
+static void RunFillReal2(size_t words)
+{	genrand_fill_real2(&BenchCtx, BenchReal, words);
+	BenchSink ^= (uint64_t)(BenchReal[words - 1] * 4294967296.0);
+}
+
+/* MT19937-64. */
+
+static void RunGenrand64Uint64(size_t words)
+{	uint64_t	x = 0;
+	size_t		i;
+
+	for (i = 0; i < words; i++) {
+		x ^= genrand64_uint64_r(&BenchCtx64);
+	}
+	BenchSink ^= x;
+}
+
+static void RunGenrand64FillUint64(size_t words)
+{	genrand64_fill_uint64(&BenchCtx64, BenchU64, words);
+	BenchSink ^= BenchU64[words - 1];
+}
+
+/* Engines. */
+
+static void RunEngineNext32(size_t words)
+{	uint32_t	x = 0;
+	size_t		i;
+
+	for (i = 0; i < words; i++) {
+		x ^= PrngEngineNext32(&BenchEngine);
+	}
+	BenchSink ^= x;
+}
+
+static void RunEngineFillUint32(size_t words)
+{	PrngEngineFillUint32(&BenchEngine, BenchU32, words);
+	BenchSink ^= BenchU32[words - 1];
+}
+
+static void RunEngineFillUint64(size_t words)
+{	PrngEngineFillUint64(&BenchEngine, BenchU64, words);
+	BenchSink ^= BenchU64[words - 1];
+}
+
+static void RunEngineFillBytes(size_t words)
+{	PrngEngineFillBytes(&BenchEngine, BenchU8, words);
+	BenchSink ^= BenchU8[words - 1];
+}
+
+static void RunEngineFillBounded32(size_t words)
+{	PrngEngineFillBounded32(&BenchEngine, BenchU32, words, 1000000007U);
+	BenchSink ^= BenchU32[words - 1];
+}
+
+static const BenchItem	BenchScalarItems[] = {
+	{"genrand_uint32_r",	sizeof(uint32_t),	1,	RunGenrandUint32},
+	{"genrand_real2_r",	sizeof(double),		1,	RunGenrandReal2},
+	{"genrand_res53_r",	sizeof(double),		1,	RunGenrandRes53},
+	{"init_genrand_r",	sizeof(uint32_t),	1,	RunInitGenrand},
+	{"init_by_array_r",	sizeof(uint32_t),	1,	RunInitByArray},
+};
+
+static const BenchItem	BenchKernelItems[] = {
+	{"genrand_fill_uint32",	sizeof(uint32_t),	1,	RunFillUint32},
+	{"genrand_fill_uint8",	sizeof(uint8_t),	1,	RunFillUint8},
+	{"genrand_fill_real2",	sizeof(double),		1,	RunFillReal2},
+};
+
+static const BenchItem	BenchMt64Items[] = {
+	{"genrand64_uint64_r",		sizeof(uint64_t),	1,	RunGenrand64Uint64},
+	{"genrand64_fill_uint64",	sizeof(uint64_t),	1,	RunGenrand64FillUint64},
+};
+
+static const BenchItem	BenchEngineItems[] = {
+	{"PrngEngineNext32",		sizeof(uint32_t),	1,	RunEngineNext32},
+	{"PrngEngineFillUint32",	sizeof(uint32_t),	1,	RunEngineFillUint32},
+	{"PrngEngineFillUint64",	sizeof(uint64_t),	1,	RunEngineFillUint64},
+	{"PrngEngineFillBytes",		sizeof(uint8_t),	1,	RunEngineFillBytes},
+	{"PrngEngineFillBounded32",	sizeof(uint32_t),	1,	RunEngineFillBounded32},
+};
+
+/*! Measure an item, print one line.
+ *  @param item points item.
+ *  @param variant kernel variant or engine name.
+ *  @param min_seconds minimum time to measure.
+ */
+static void BenchMeasure(const BenchItem *item, const char *variant, double min_seconds)
+{	double		t0;
+	double		t;
+	uint64_t	words = 0;
+	double		ns_word;
+	double		gb_s;
+
+	/* Warm up, page in buffers. */
+	item->Run(BENCH_BATCH_WORDS);
+	t0 = Now();
+	do {
+		item->Run(BENCH_BATCH_WORDS);
+		words += BENCH_BATCH_WORDS;
+		t = Now() - t0;
+	} while (t < min_seconds);
+	words *= item->Scale;
+	ns_word = t * 1e9 / (double)words;
+	gb_s = (double)words * (double)(item->WordBytes) / t / 1e9;
+	printf("%-26s %-14s %10.3f %10.3f\n", item->Name, variant, ns_word, gb_s);
+}
+
+static void BenchHeader(void)
+{	printf("%-26s %-14s %10s %10s\n", "function", "variant", "ns/word", "GB/s");
+}
+
+/*! Measure latency of genrand_jump_r(), print one line.
+ *  Jump ahead skips words without generating them, so report
+ *  time per call instead of ns/word and GB/s.
+ *  @param variant kernel variant name.
+ *  @param min_seconds minimum time to measure.
+ */
+static void BenchJump(const char *variant, double min_seconds)
+{	double		t0;
+	double		t;
+	uint64_t	jumps = 0;
+
+	/* Warm up. */
+	genrand_jump_r(&BenchCtx, BENCH_JUMP_WORDS);
+	t0 = Now();
+	do {
+		genrand_jump_r(&BenchCtx, BENCH_JUMP_WORDS);
+		jumps++;
+		t = Now() - t0;
+	} while (t < min_seconds);
+	BenchSink ^= genrand_uint32_r(&BenchCtx);
+	printf("%-26s %-14s %10.0f\n", "genrand_jump_r", variant, t * 1e9 / (double)jumps);
+}
+
+static void BenchJumpHeader(void)
+{	printf("%-26s %-14s %10s\n", "function (2^30 words)", "variant", "ns/jump");
+}
+
+/*! Read whole file.
+ *  @param path file path.
+ *  @param len points variable to store length.
+ *  @return char * file content, NULL on error. Caller frees it.
+ */
+static char *ReadFile(const char *path, size_t *len)
+{	FILE	*fp;
+	char	*buf = NULL;
+	size_t	size = 0;
+	size_t	n = 0;
+	size_t	r;
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		fprintf(fpError, "%s: ERROR: Can not open golden file, %s.\n",
+			path, strerror(errno)
+		);
+		return NULL;
+	}
+	do {
+		if (n == size) {
+			char	*p;
+
+			size = size ? size * 2 : 65536;
+			p = realloc(buf, size);
+			if (!p) {
+				free(buf);
+				fclose(fp);
+				return NULL;
+			}
+			buf = p;
+		}
+		r = fread(buf + n, 1, size - n, fp);
+		n += r;
+	} while (r > 0);
+	fclose(fp);
+	*len = n;
+	return buf;
+}
+
+/*! Print golden format output using bulk fill functions.
+ *  @param fp output stream.
+ */
+static void GoldenPrint(FILE *fp)
+{	static mt19937ar_ctx	ctx;
+	int	i;
+
+	init_by_array_r(&ctx, GoldenKey, ElementsOf(GoldenKey));
+	genrand_fill_uint32(&ctx, BenchU32, GOLDEN_OUTPUTS);
+	genrand_fill_real2(&ctx, BenchReal, GOLDEN_OUTPUTS);
+	fprintf(fp, "1000 outputs of genrand_int32()\n");
+	for (i = 0; i < GOLDEN_OUTPUTS; i++) {
+		fprintf(fp, "%10lu ", (unsigned long)(BenchU32[i]));
+		if (i % 5 == 4) fprintf(fp, "\n");
+	}
+	fprintf(fp, "\n1000 outputs of genrand_real2()\n");
+	for (i = 0; i < GOLDEN_OUTPUTS; i++) {
+		fprintf(fp, "%10.8f ", BenchReal[i]);
+		if (i % 5 == 4) fprintf(fp, "\n");
+	}
+}
+
+/*! Compare output of current kernel variant to golden file.
+ *  @return bool true: match.
+ */
+static bool GoldenCheck(const char *golden, size_t golden_len)
+{	char	*out = NULL;
+	size_t	out_len = 0;
+	FILE	*fp;
+	bool	result;
+
+	fp = open_memstream(&out, &out_len);
+	if (!fp) {
+		return false;
+	}
+	GoldenPrint(fp);
+	fclose(fp);
+	result = (out_len == golden_len) && (memcmp(out, golden, out_len) == 0);
+	free(out);
+	return result;
+}
+
+int main(int argc, char **argv)
+{	static const char *const	isas[] = {"avx512", "avx2", "baseline"};
+	const PrngEngineOps *const	*e;
+	const char	*golden_path = NULL;
+	char		*golden = NULL;
+	size_t		golden_len = 0;
+	double		min_seconds = BENCH_MIN_SECONDS;
+	const char	*kernel_auto;
+	char		*p;
+	int		result = 0;
+	int		opt;
+	size_t		i;
+	size_t		k;
+
+	fpError = stderr;
+
+	while ((opt = getopt(argc, argv, "t:h")) != -1) {
+		switch (opt) {
+		case 't':
+			min_seconds = strtod(optarg, &p);
+			if ((p == optarg) || (min_seconds <= 0.0)) {
+				fprintf(fpError, "%s: ERROR: Specify positive seconds to -t option.\n",
+					argv[0]
+				);
+				return 1;
+			}
+			break;
+		case 'h':
+		default:
+			fprintf(fpError, HelpMessage,
+				argv[0], argv[0], argv[0], BENCH_MIN_SECONDS, argv[0], argv[0]
+			);
+			return 1;
+		}
+	}
+	if (optind < argc) {
+		golden_path = argv[optind];
+		golden = ReadFile(golden_path, &golden_len);
+		if (!golden) {
+			return 1;
+		}
+	}
+
+	kernel_auto = genrand_kernel_name();
+
+	/* Correctness of each kernel variant. */
+	for (k = 0; (golden) && (k < ElementsOf(isas)); k++) {
+		if (genrand_kernel_select(isas[k]) != 0) {
+			printf("SKIP: %s is not supported.\n", isas[k]);
+			continue;
+		}
+		if (GoldenCheck(golden, golden_len)) {
+			printf("PASS: %s matches to %s.\n", isas[k], golden_path);
+		} else {
+			printf("FAIL: %s does not match to %s.\n", isas[k], golden_path);
+			result = 1;
+		}
+	}
+	free(golden);
+
+	BenchHeader();
+	genrand_kernel_select(kernel_auto);
+	init_by_array_r(&BenchCtx, GoldenKey, ElementsOf(GoldenKey));
+	for (i = 0; i < ElementsOf(BenchScalarItems); i++) {
+		BenchMeasure(&BenchScalarItems[i], kernel_auto, min_seconds);
+	}
+	for (k = 0; k < ElementsOf(isas); k++) {
+		if (genrand_kernel_select(isas[k]) != 0) {
+			continue;
+		}
+		for (i = 0; i < ElementsOf(BenchKernelItems); i++) {
+			BenchMeasure(&BenchKernelItems[i], isas[k], min_seconds);
+		}
+	}
+
+	BenchJumpHeader();
+	for (k = 0; k < ElementsOf(isas); k++) {
+		if (genrand_kernel_select(isas[k]) != 0) {
+			continue;
+		}
+		BenchJump(isas[k], min_seconds);
+	}
+	genrand_kernel_select(kernel_auto);
+
+	BenchHeader();
+	init_genrand64_r(&BenchCtx64, 5489);
+	for (i = 0; i < ElementsOf(BenchMt64Items); i++) {
+		BenchMeasure(&BenchMt64Items[i], "mt64", min_seconds);
+	}
+
+	for (e = &(PrngEngines[0]); *e != NULL; e++) {
+		if (!PrngEngineInit(&BenchEngine, *e)) {
+			fprintf(fpError, "%s: ERROR: Can not allocate engine context. engine=%s\n",
+				argv[0], (*e)->Name
+			);
+			return 1;
+		}
+		PrngEngineSeed(&BenchEngine, 5489);
+		for (i = 0; i < ElementsOf(BenchEngineItems); i++) {
+			BenchMeasure(&BenchEngineItems[i], (*e)->Name, min_seconds);
+		}
+		PrngEngineFree(&BenchEngine);
+	}
+	return result;
+}
@@ -46,13 +46,313 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 #include "mt19937ar.h"
+#include "philox4x32.h"
+#include "xoshiro256ss.h"
+#include "prng-engine.h"
 
-int main(void)
+#define OUTPUTS (1000)
+
+/* Chunk lengths to call bulk fill functions, crossing N boundaries. */
+static const size_t fill_chunks[] = {1, 7, 623, 2, 624, 625, 5, 1250};
+
+/* Fill array by bulk fill function in various chunk lengths. */
+static void fill_uint32_chunks(mt19937ar_ctx *ctx, uint32_t *dst, size_t n)
+{
+    size_t c = 0;
+    size_t m;
+
+    while (n) {
+        m = fill_chunks[c % (sizeof(fill_chunks) / sizeof(fill_chunks[0]))];
+        if (m > n) m = n;
+        genrand_fill_uint32(ctx, dst, m);
+        dst += m; n -= m; c++;
+    }
+}
+
+static void fill_real2_chunks(mt19937ar_ctx *ctx, double *dst, size_t n)
+{
+    size_t c = 0;
+    size_t m;
+
+    while (n) {
+        m = fill_chunks[c % (sizeof(fill_chunks) / sizeof(fill_chunks[0]))];
+        if (m > n) m = n;
+        genrand_fill_real2(ctx, dst, m);
+        dst += m; n -= m; c++;
+    }
+}
+
+/* Test bulk fill functions, print same format as sequential test. */
+static int bulk_test(uint32_t init[], int length)
+{
+    static mt19937ar_ctx ctx;
+    static mt19937ar_ctx ctx8;
+    static uint32_t u32[OUTPUTS];
+    static uint8_t u8[OUTPUTS * 2];
+    static double r2[OUTPUTS];
+    int result = 0;
+    int i;
+
+    init_by_array_r(&ctx, init, length);
+    init_by_array_r(&ctx8, init, length);
+    fill_uint32_chunks(&ctx, u32, OUTPUTS);
+    fill_real2_chunks(&ctx, r2, OUTPUTS);
+    genrand_fill_uint8(&ctx8, u8, sizeof(u8));
+    for (i=0; i<OUTPUTS; i++) {
+      if ((u8[i] != (uint8_t)u32[i]) ||
+          (u8[OUTPUTS + i] != (uint8_t)(uint32_t)(r2[i] * 4294967296.0))) {
+        fprintf(stderr, "genrand_fill_uint8(): Mismatch at %d\n", i);
+        result = 1;
+        break;
+      }
+    }
+    printf("1000 outputs of genrand_int32()\n");
+    for (i=0; i<OUTPUTS; i++) {
+      printf("%10lu ",(unsigned long)(u32[i]));
+      if (i%5==4) printf("\n");
+    }
+    printf("\n1000 outputs of genrand_real2()\n");
+    for (i=0; i<OUTPUTS; i++) {
+      printf("%10.8f ", r2[i]);
+      if (i%5==4) printf("\n");
+    }
+    return result;
+}
+
+/* Jump distances to test, around block boundaries and direct
+   regeneration threshold. */
+static const uint64_t jump_words[] = {
+    0, 1, 623, 624, 625, 1000,
+    (uint64_t)MT19937AR_N * MT19937AR_JUMP_DIRECT_BLOCKS + 1,
+    (uint64_t)MT19937AR_N * (MT19937AR_JUMP_DIRECT_BLOCKS + 1),
+    (uint64_t)MT19937AR_N * (MT19937AR_JUMP_DIRECT_BLOCKS + 1) + 623,
+    12345678, 100000007,
+};
+
+/* Test jump ahead, compare to skipping numbers sequentially. */
+static int jump_test(uint32_t init[], int length)
+{
+    static mt19937ar_ctx seq;
+    static mt19937ar_ctx jmp;
+    static mt19937ar_jump jp;
+    static uint32_t skip[MT19937AR_N * 16];
+    uint64_t n;
+    uint64_t m;
+    size_t i;
+    int k;
+    int result = 0;
+
+    for (i = 0; i < sizeof(jump_words) / sizeof(jump_words[0]); i++) {
+      /* Start from the middle of a block, then at the block end. */
+      for (k = 0; k < 2; k++) {
+        init_by_array_r(&seq, init, length);
+        genrand_fill_uint32(&seq, skip, (k == 0) ? 100 : MT19937AR_N);
+        jmp = seq;
+
+        genrand_jump_prepare(&jp, jump_words[i]);
+        genrand_jump_apply_r(&jmp, &jp);
+        for (n = jump_words[i]; n; n -= m) {
+          m = (n < (sizeof(skip) / sizeof(skip[0]))) ? n : (sizeof(skip) / sizeof(skip[0]));
+          genrand_fill_uint32(&seq, skip, (size_t)m);
+        }
+        for (n = 0; n < 2 * MT19937AR_N; n++) {
+          if (genrand_uint32_r(&seq) != genrand_uint32_r(&jmp)) {
+            fprintf(stderr, "jump %" PRIu64 " words: Mismatch at %" PRIu64 "\n",
+                jump_words[i], n);
+            result = 1;
+            break;
+          }
+        }
+      }
+    }
+    return result;
+}
+
+/* Discard distances to test engines, around philox4x32 block and
+   over direct stepping thresholds of engines. */
+static const uint64_t discard_draws[] = {0, 1, 3, 4, 5, 623, 1000, 12345, 5616001};
+
+/* Ranges to test bounded sampling, 0x80000001 rejects almost half. */
+static const uint64_t bounded_ranges[] = {
+    0, 1, 3, 1000, 0x80000001ULL, 0xffffffffULL, 0x100000000ULL,
+    0x8000000000000001ULL,
+};
+
+/* Test bounded sampling, compare bulk fill to drawing one by one. */
+static int bounded_test(const PrngEngineOps *ops)
+{
+    static uint32_t b32[OUTPUTS];
+    static uint64_t b64[OUTPUTS];
+    PrngEngine seq;
+    PrngEngine blk;
+    uint64_t range;
+    uint32_t v32;
+    uint64_t v64;
+    size_t i;
+    size_t k;
+    int result = 0;
+
+    if ((!PrngEngineInit(&seq, ops)) || (!PrngEngineInit(&blk, ops))) {
+      fprintf(stderr, "%s: Can not allocate context\n", ops->Name);
+      return 1;
+    }
+    for (k = 0; k < sizeof(bounded_ranges) / sizeof(bounded_ranges[0]); k++) {
+      range = bounded_ranges[k];
+      PrngEngineSeed(&seq, 5489);
+      PrngEngineSeed(&blk, 5489);
+      if (range <= 0xffffffffULL) {
+        PrngEngineFillBounded32(&blk, b32, OUTPUTS, (uint32_t)range);
+        for (i = 0; i < OUTPUTS; i++) {
+          v32 = PrngEngineBounded32(&seq, (uint32_t)range);
+          if ((v32 != b32[i]) || ((range != 0) && (v32 >= range))) {
+            fprintf(stderr, "%s: Bounded32 %" PRIu64 " mismatch at %zu\n",
+                ops->Name, range, i);
+            result = 1;
+            break;
+          }
+        }
+      }
+      PrngEngineFillBounded64(&blk, b64, OUTPUTS, range);
+      for (i = 0; i < OUTPUTS; i++) {
+        v64 = PrngEngineBounded64(&seq, range);
+        if ((v64 != b64[i]) || ((range != 0) && (v64 >= range))) {
+          fprintf(stderr, "%s: Bounded64 %" PRIu64 " mismatch at %zu\n",
+              ops->Name, range, i);
+          result = 1;
+          break;
+        }
+      }
+    }
+    PrngEngineFree(&seq);
+    PrngEngineFree(&blk);
+    return result;
+}
+
+/* Draw as FillBytes() does, the least significant 8 bits of a draw. */
+static uint8_t engine_draw_byte(PrngEngine *pe)
+{
+    if (pe->Ops->DrawBits == 64) {
+      return (uint8_t)PrngEngineNext64(pe);
+    }
+    return (uint8_t)PrngEngineNext32(pe);
+}
+
+/* Test engines, compare bulk fill and discard to drawing one by one. */
+static int engine_test(void)
+{
+    static const uint32_t philox_key[2] = {0, 0};
+    static const uint32_t philox_kat[PHILOX4X32_BLOCK_WORDS] =
+      {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8};
+    static const uint64_t xoshiro_kat[4] =
+      {UINT64_C(11520), UINT64_C(0), UINT64_C(1509978240), UINT64_C(1215971899390074240)};
+    static uint8_t bytes[OUTPUTS];
+    const PrngEngineOps *const *e;
+    PrngEngine seq;
+    PrngEngine blk;
+    uint32_t out[PHILOX4X32_BLOCK_WORDS];
+    xoshiro256ss_ctx xs = {{1, 2, 3, 4}};
+    uint64_t n;
+    size_t i;
+    size_t c;
+    size_t m;
+    int result = 0;
+
+    /* Known answer, Random123 kat_vectors. */
+    philox4x32_block(philox_key, 0, out);
+    if (memcmp(out, philox_kat, sizeof(out)) != 0) {
+      fprintf(stderr, "philox4x32: Known answer mismatch\n");
+      result = 1;
+    }
+
+    /* Known answer, reference xoshiro256starstar.c from state {1, 2, 3, 4}. */
+    for (i = 0; i < sizeof(xoshiro_kat) / sizeof(xoshiro_kat[0]); i++) {
+      if (xoshiro256ss_next64(&xs) != xoshiro_kat[i]) {
+        fprintf(stderr, "xoshiro256ss: Known answer mismatch at %zu\n", i);
+        result = 1;
+        break;
+      }
+    }
+
+    for (e = &(PrngEngines[0]); *e != NULL; e++) {
+      if ((!PrngEngineInit(&seq, *e)) || (!PrngEngineInit(&blk, *e))) {
+        fprintf(stderr, "%s: Can not allocate context\n", (*e)->Name);
+        return 1;
+      }
+      PrngEngineSeed(&seq, 5489);
+      PrngEngineSeed(&blk, 5489);
+      for (i = 0, c = 0; i < OUTPUTS; i += m, c++) {
+        m = fill_chunks[c % (sizeof(fill_chunks) / sizeof(fill_chunks[0]))];
+        if (m > OUTPUTS - i) m = OUTPUTS - i;
+        PrngEngineFillBytes(&blk, bytes + i, m);
+      }
+      for (i = 0; i < OUTPUTS; i++) {
+        if (bytes[i] != engine_draw_byte(&seq)) {
+          fprintf(stderr, "%s: FillBytes mismatch at %zu\n", (*e)->Name, i);
+          result = 1;
+          break;
+        }
+      }
+      for (i = 0; i < sizeof(discard_draws) / sizeof(discard_draws[0]); i++) {
+        void *jump;
+
+        jump = PrngEngineJumpNew(*e, discard_draws[i]);
+        if (!jump) {
+          fprintf(stderr, "%s: Can not allocate jump\n", (*e)->Name);
+          return 1;
+        }
+        PrngEngineSeed(&seq, 5489);
+        PrngEngineSeed(&blk, 5489);
+        /* Discard() and Jump() in turn, both skip the same draws. */
+        if (i % 2) {
+          PrngEngineDiscard(&blk, discard_draws[i]);
+        } else {
+          (void)PrngEngineNext32(&seq);
+          (void)PrngEngineNext32(&blk);
+          PrngEngineJump(&blk, jump);
+        }
+        PrngEngineJumpFree(*e, jump);
+        for (n = 0; n < discard_draws[i]; n++) {
+          (void)engine_draw_byte(&seq);
+        }
+        for (n = 0; n < 16; n++) {
+          if (PrngEngineNext64(&seq) != PrngEngineNext64(&blk)) {
+            fprintf(stderr, "%s: Discard %" PRIu64 " draws mismatch at %" PRIu64 "\n",
+                (*e)->Name, discard_draws[i], n);
+            result = 1;
+            break;
+          }
+        }
+      }
+      PrngEngineFree(&seq);
+      PrngEngineFree(&blk);
+      if (bounded_test(*e) != 0) {
+        result = 1;
+      }
+    }
+    return result;
+}
+
+/* mtTest: Sequential test.
+   mtTest -b: Bulk fill test.
+   mtTest -j: Jump ahead test.
+   mtTest -e: Engine test.
+*/
+int main(int argc, char **argv)
 {
     int i;
     uint32_t init[4]={0x123, 0x234, 0x345, 0x456};
     int length=4;
+    if ((argc > 1) && (strcmp(argv[1], "-b") == 0)) {
+      return bulk_test(init, length);
+    }
+    if ((argc > 1) && (strcmp(argv[1], "-j") == 0)) {
+      return jump_test(init, length);
+    }
+    if ((argc > 1) && (strcmp(argv[1], "-e") == 0)) {
+      return engine_test();
+    }
     init_by_array(init, length);
     printf("1000 outputs of genrand_int32()\n");
     for (i=0; i<1000; i++) {
@@ -0,0 +1,170 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* Philox4x32-10, counter-based pseudo random number generator.
+ * Algorithm by John K. Salmon, Mark A. Moraes, Ron O. Dror and
+ * David E. Shaw, "Parallel random numbers: as easy as 1, 2, 3" (SC11).
+ * Counter is (block index low, block index high, 0, 0).
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include "philox4x32.h"
+
+#define	PHILOX_M0	(0xd2511f53U)
+#define	PHILOX_M1	(0xcd9e8d57U)
+#define	PHILOX_W0	(0x9e3779b9U)	/* golden ratio */
+#define	PHILOX_W1	(0xbb67ae85U)	/* sqrt(3) - 1 */
+#define	PHILOX_ROUNDS	(10)
+
+/*! No block is cached, never equals to a block index in use. */
+#define	PHILOX_CACHED_NONE	(~(uint64_t)0)
+
+/*! computes output block at counter block with key
+    @param key 64 bit key.
+    @param block block index (counter).
+    @param out points 4 words to store output.
+*/
+void philox4x32_block(const uint32_t key[2], uint64_t block,
+	uint32_t out[PHILOX4X32_BLOCK_WORDS])
+{	uint32_t	c0, c1, c2, c3;
+	uint32_t	k0, k1;
+	uint64_t	p0, p1;
+	int		r;
+
+	c0 = (uint32_t)block;
+	c1 = (uint32_t)(block >> 32);
+	c2 = 0;
+	c3 = 0;
+	k0 = key[0];
+	k1 = key[1];
+	for (r = 0; r < PHILOX_ROUNDS; r++) {
+		p0 = (uint64_t)PHILOX_M0 * c0;
+		p1 = (uint64_t)PHILOX_M1 * c2;
+		c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		c1 = (uint32_t)p1;
+		c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c3 = (uint32_t)p0;
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+/*! initializes ctx from 64 bit seed, position is set to 0
+    @param ctx points context.
+    @param seed random seed, used as key.
+*/
+void philox4x32_seed(philox4x32_ctx *ctx, uint64_t seed)
+{	ctx->key[0] = (uint32_t)seed;
+	ctx->key[1] = (uint32_t)(seed >> 32);
+	ctx->pos = 0;
+	ctx->cached = PHILOX_CACHED_NONE;
+}
+
+/*! moves to word position pos
+    @param ctx points context.
+    @param pos word position from the beginning of stream.
+*/
+void philox4x32_seek(philox4x32_ctx *ctx, uint64_t pos)
+{	ctx->pos = pos;
+}
+
+/*! skips n words
+    @param ctx points context.
+    @param n the number of words to skip.
+*/
+void philox4x32_discard(philox4x32_ctx *ctx, uint64_t n)
+{	ctx->pos += n;
+}
+
+/*! makes out[] hold block at current position
+    @param ctx points context.
+    @return uint64_t block index of current position.
+*/
+static inline uint64_t philox4x32_load(philox4x32_ctx *ctx)
+{	uint64_t	block;
+
+	block = ctx->pos / PHILOX4X32_BLOCK_WORDS;
+	if (ctx->cached != block) {
+		philox4x32_block(ctx->key, block, ctx->out);
+		ctx->cached = block;
+	}
+	return block;
+}
+
+/*! generates a random number on [0,0xffffffff]-interval
+    @param ctx points context.
+    @return uint32_t generated random number.
+*/
+uint32_t philox4x32_next32(philox4x32_ctx *ctx)
+{	uint32_t	y;
+
+	philox4x32_load(ctx);
+	y = ctx->out[ctx->pos % PHILOX4X32_BLOCK_WORDS];
+	ctx->pos++;
+	return y;
+}
+
+/*! fills array with random numbers
+    @param ctx points context.
+    @param dst points array to fill.
+    @param n the number of elements to fill.
+*/
+void philox4x32_fill_uint32(philox4x32_ctx *ctx, uint32_t *dst, size_t n)
+{	uint64_t	block;
+
+	/* Words left in cached block. */
+	while ((n > 0) && ((ctx->pos % PHILOX4X32_BLOCK_WORDS) != 0)) {
+		*dst = philox4x32_next32(ctx);
+		dst++;
+		n--;
+	}
+	/* Full blocks, generate into dst directly. */
+	block = ctx->pos / PHILOX4X32_BLOCK_WORDS;
+	while (n >= PHILOX4X32_BLOCK_WORDS) {
+		philox4x32_block(ctx->key, block, dst);
+		block++;
+		dst += PHILOX4X32_BLOCK_WORDS;
+		n -= PHILOX4X32_BLOCK_WORDS;
+		ctx->pos += PHILOX4X32_BLOCK_WORDS;
+	}
+	while (n > 0) {
+		*dst = philox4x32_next32(ctx);
+		dst++;
+		n--;
+	}
+}
+
+/*! fills array with least significant 8 bits of random numbers
+    @param ctx points context.
+    @param dst points array to fill.
+    @param n the number of bytes to fill.
+*/
+void philox4x32_fill_uint8(philox4x32_ctx *ctx, uint8_t *dst, size_t n)
+{	uint32_t	w[PHILOX4X32_BLOCK_WORDS];
+	uint64_t	block;
+
+	while ((n > 0) && ((ctx->pos % PHILOX4X32_BLOCK_WORDS) != 0)) {
+		*dst = (uint8_t)philox4x32_next32(ctx);
+		dst++;
+		n--;
+	}
+	block = ctx->pos / PHILOX4X32_BLOCK_WORDS;
+	while (n >= PHILOX4X32_BLOCK_WORDS) {
+		philox4x32_block(ctx->key, block, w);
+		dst[0] = (uint8_t)w[0];
+		dst[1] = (uint8_t)w[1];
+		dst[2] = (uint8_t)w[2];
+		dst[3] = (uint8_t)w[3];
+		block++;
+		dst += PHILOX4X32_BLOCK_WORDS;
+		n -= PHILOX4X32_BLOCK_WORDS;
+		ctx->pos += PHILOX4X32_BLOCK_WORDS;
+	}
+	while (n > 0) {
+		*dst = (uint8_t)philox4x32_next32(ctx);
+		dst++;
+		n--;
+	}
+}
@@ -0,0 +1,47 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* Philox4x32-10, counter-based pseudo random number generator.
+ * Algorithm by John K. Salmon, Mark A. Moraes, Ron O. Dror and
+ * David E. Shaw, "Parallel random numbers: as easy as 1, 2, 3" (SC11).
+ * Output block i (four 32 bit words) depends only on (seed, i),
+ * so any position of the stream is reachable in O(1).
+ * Not compatible with MT19937.
+ */
+#if (!defined(PHILOX4X32_H))
+#define PHILOX4X32_H
+#include <stddef.h>
+#include <stdint.h>
+
+/*! Words per block. */
+#define	PHILOX4X32_BLOCK_WORDS	(4)
+
+/*! Philox4x32-10 generator state (context). */
+typedef struct philox4x32_ctx {
+	uint32_t	key[2];		/*!< key, taken from seed */
+	uint64_t	pos;		/*!< next word position in stream */
+	uint64_t	cached;		/*!< block index held in out[] */
+	uint32_t	out[PHILOX4X32_BLOCK_WORDS];	/*!< output of block cached */
+} philox4x32_ctx;
+
+/* computes output block at counter block with key */
+void philox4x32_block(const uint32_t key[2], uint64_t block,
+	uint32_t out[PHILOX4X32_BLOCK_WORDS]);
+
+/* initializes ctx from 64 bit seed, position is set to 0 */
+void philox4x32_seed(philox4x32_ctx *ctx, uint64_t seed);
+
+/* moves to word position pos, O(1) */
+void philox4x32_seek(philox4x32_ctx *ctx, uint64_t pos);
+
+/* skips n words, O(1) */
+void philox4x32_discard(philox4x32_ctx *ctx, uint64_t n);
+
+/* generates a random number on [0,0xffffffff]-interval */
+uint32_t philox4x32_next32(philox4x32_ctx *ctx);
+
+/* fills dst[n] with random numbers, same as calling next32 n times */
+void philox4x32_fill_uint32(philox4x32_ctx *ctx, uint32_t *dst, size_t n);
+
+/* fills dst[n] with least significant 8 bits of random numbers */
+void philox4x32_fill_uint8(philox4x32_ctx *ctx, uint8_t *dst, size_t n);
+
+#endif /* (!defined(PHILOX4X32_H)) */
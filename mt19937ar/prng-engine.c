@@ -0,0 +1,481 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* Pseudo random number generator engine interface. */
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mt19937ar.h"
+#include "mt19937-64.h"
+#include "xoshiro256ss.h"
+#include "philox4x32.h"
+#include "prng-engine.h"
+
+/*! Context alignment, a cache line. */
+#define	PRNG_ENGINE_CONTEXT_ALIGN	(64)
+
+/*! Words to combine at once, when 32 bit engine fills 64 bit array. */
+#define	PRNG_ENGINE_COMBINE_WORDS	(256)
+
+/* Prepared jump of engines without precomputation, holds draws. */
+
+static void *DiscardJumpNew(uint64_t draws)
+{	uint64_t	*jump;
+
+	jump = malloc(sizeof(*jump));
+	if (jump) {
+		*jump = draws;
+	}
+	return jump;
+}
+
+static void DiscardJumpFree(void *jump)
+{	free(jump);
+}
+
+/* MT19937, "mt19937ar" engine. */
+
+static void Mt19937arSeed(void *ctx, uint64_t seed)
+{	init_genrand_r((mt19937ar_ctx *)ctx, (uint32_t)seed);
+}
+
+static uint32_t Mt19937arNext32(void *ctx)
+{	return genrand_uint32_r((mt19937ar_ctx *)ctx);
+}
+
+static uint64_t Mt19937arNext64(void *ctx)
+{	uint64_t	r;
+
+	r = ((uint64_t)genrand_uint32_r((mt19937ar_ctx *)ctx)) << 32;
+	r |= genrand_uint32_r((mt19937ar_ctx *)ctx);
+	return r;
+}
+
+static void Mt19937arFillUint32(void *ctx, uint32_t *dst, size_t n)
+{	genrand_fill_uint32((mt19937ar_ctx *)ctx, dst, n);
+}
+
+static void Mt19937arFillUint64(void *ctx, uint64_t *dst, size_t n)
+{	uint32_t	w[PRNG_ENGINE_COMBINE_WORDS * 2];
+	size_t		m;
+	size_t		i;
+
+	while (n) {
+		m = n;
+		if (m > PRNG_ENGINE_COMBINE_WORDS) {
+			m = PRNG_ENGINE_COMBINE_WORDS;
+		}
+		genrand_fill_uint32((mt19937ar_ctx *)ctx, w, m * 2);
+		for (i = 0; i < m; i++) {
+			dst[i] = (((uint64_t)w[i * 2]) << 32) | w[i * 2 + 1];
+		}
+		dst += m;
+		n -= m;
+	}
+}
+
+static void Mt19937arFillBytes(void *ctx, uint8_t *dst, size_t n)
+{	genrand_fill_uint8((mt19937ar_ctx *)ctx, dst, n);
+}
+
+static void Mt19937arDiscard(void *ctx, uint64_t draws)
+{	genrand_jump_r((mt19937ar_ctx *)ctx, draws);
+}
+
+/* @note Prepares jump polynomial once, the costly part of jump. */
+static void *Mt19937arJumpNew(uint64_t draws)
+{	mt19937ar_jump	*jp;
+
+	jp = malloc(sizeof(*jp));
+	if (jp) {
+		genrand_jump_prepare(jp, draws);
+	}
+	return jp;
+}
+
+static void Mt19937arJump(void *ctx, const void *jump)
+{	genrand_jump_apply_r((mt19937ar_ctx *)ctx, (const mt19937ar_jump *)jump);
+}
+
+const PrngEngineOps PrngEngineMt19937ar = {
+	.Name =		"mt19937ar",
+	.Description =	"MT19937 Mersenne Twister, 32 bits per draw (default)",
+	.ContextSize =	sizeof(mt19937ar_ctx),
+	.DrawBits =	32,
+	.Seed =		Mt19937arSeed,
+	.Next32 =	Mt19937arNext32,
+	.Next64 =	Mt19937arNext64,
+	.FillUint32 =	Mt19937arFillUint32,
+	.FillUint64 =	Mt19937arFillUint64,
+	.FillBytes =	Mt19937arFillBytes,
+	.Discard =	Mt19937arDiscard,
+	.JumpNew =	Mt19937arJumpNew,
+	.Jump =		Mt19937arJump,
+	.JumpFree =	DiscardJumpFree,
+};
+
+/* MT19937-64, "mt64" engine. */
+
+static void Mt64Seed(void *ctx, uint64_t seed)
+{	init_genrand64_r((mt19937_64_ctx *)ctx, seed);
+}
+
+static uint32_t Mt64Next32(void *ctx)
+{	return (uint32_t)(genrand64_uint64_r((mt19937_64_ctx *)ctx) >> 32);
+}
+
+static uint64_t Mt64Next64(void *ctx)
+{	return genrand64_uint64_r((mt19937_64_ctx *)ctx);
+}
+
+static void Mt64FillUint32(void *ctx, uint32_t *dst, size_t n)
+{	uint64_t	w[PRNG_ENGINE_COMBINE_WORDS];
+	size_t		m;
+	size_t		i;
+
+	while (n) {
+		m = n;
+		if (m > PRNG_ENGINE_COMBINE_WORDS) {
+			m = PRNG_ENGINE_COMBINE_WORDS;
+		}
+		genrand64_fill_uint64((mt19937_64_ctx *)ctx, w, m);
+		for (i = 0; i < m; i++) {
+			dst[i] = (uint32_t)(w[i] >> 32);
+		}
+		dst += m;
+		n -= m;
+	}
+}
+
+static void Mt64FillUint64(void *ctx, uint64_t *dst, size_t n)
+{	genrand64_fill_uint64((mt19937_64_ctx *)ctx, dst, n);
+}
+
+static void Mt64FillBytes(void *ctx, uint8_t *dst, size_t n)
+{	genrand64_fill_uint8((mt19937_64_ctx *)ctx, dst, n);
+}
+
+static void Mt64Discard(void *ctx, uint64_t draws)
+{	genrand64_jump_r((mt19937_64_ctx *)ctx, draws);
+}
+
+/* @note Prepares jump polynomial once, the costly part of jump. */
+static void *Mt64JumpNew(uint64_t draws)
+{	mt19937_64_jump	*jp;
+
+	jp = malloc(sizeof(*jp));
+	if (jp) {
+		genrand64_jump_prepare(jp, draws);
+	}
+	return jp;
+}
+
+static void Mt64Jump(void *ctx, const void *jump)
+{	genrand64_jump_apply_r((mt19937_64_ctx *)ctx, (const mt19937_64_jump *)jump);
+}
+
+const PrngEngineOps PrngEngineMt64 = {
+	.Name =		"mt64",
+	.Description =	"MT19937-64 Mersenne Twister, 64 bits per draw",
+	.ContextSize =	sizeof(mt19937_64_ctx),
+	.DrawBits =	64,
+	.Seed =		Mt64Seed,
+	.Next32 =	Mt64Next32,
+	.Next64 =	Mt64Next64,
+	.FillUint32 =	Mt64FillUint32,
+	.FillUint64 =	Mt64FillUint64,
+	.FillBytes =	Mt64FillBytes,
+	.Discard =	Mt64Discard,
+	.JumpNew =	Mt64JumpNew,
+	.Jump =		Mt64Jump,
+	.JumpFree =	DiscardJumpFree,
+};
+
+/* xoshiro256**, "xoshiro256ss" engine. */
+
+static void Xoshiro256ssSeed(void *ctx, uint64_t seed)
+{	xoshiro256ss_seed((xoshiro256ss_ctx *)ctx, seed);
+}
+
+static uint32_t Xoshiro256ssNext32(void *ctx)
+{	return (uint32_t)(xoshiro256ss_next64((xoshiro256ss_ctx *)ctx) >> 32);
+}
+
+static uint64_t Xoshiro256ssNext64(void *ctx)
+{	return xoshiro256ss_next64((xoshiro256ss_ctx *)ctx);
+}
+
+static void Xoshiro256ssFillUint32(void *ctx, uint32_t *dst, size_t n)
+{	xoshiro256ss_ctx	c;
+	size_t			i;
+
+	c = *(xoshiro256ss_ctx *)ctx;
+	for (i = 0; i < n; i++) {
+		dst[i] = (uint32_t)(xoshiro256ss_next64(&c) >> 32);
+	}
+	*(xoshiro256ss_ctx *)ctx = c;
+}
+
+static void Xoshiro256ssFillUint64(void *ctx, uint64_t *dst, size_t n)
+{	xoshiro256ss_fill_uint64((xoshiro256ss_ctx *)ctx, dst, n);
+}
+
+static void Xoshiro256ssFillBytes(void *ctx, uint8_t *dst, size_t n)
+{	xoshiro256ss_fill_uint8((xoshiro256ss_ctx *)ctx, dst, n);
+}
+
+static void Xoshiro256ssDiscard(void *ctx, uint64_t draws)
+{	xoshiro256ss_discard((xoshiro256ss_ctx *)ctx, draws);
+}
+
+static void *Xoshiro256ssJumpNew(uint64_t draws)
+{	xoshiro256ss_jump	*jp;
+
+	jp = malloc(sizeof(*jp));
+	if (jp) {
+		xoshiro256ss_jump_prepare(jp, draws);
+	}
+	return jp;
+}
+
+static void Xoshiro256ssJump(void *ctx, const void *jump)
+{	xoshiro256ss_jump_apply((xoshiro256ss_ctx *)ctx, (const xoshiro256ss_jump *)jump);
+}
+
+const PrngEngineOps PrngEngineXoshiro256ss = {
+	.Name =		"xoshiro256ss",
+	.Description =	"xoshiro256**, 64 bits per draw, fast, not MT compatible",
+	.ContextSize =	sizeof(xoshiro256ss_ctx),
+	.DrawBits =	64,
+	.Seed =		Xoshiro256ssSeed,
+	.Next32 =	Xoshiro256ssNext32,
+	.Next64 =	Xoshiro256ssNext64,
+	.FillUint32 =	Xoshiro256ssFillUint32,
+	.FillUint64 =	Xoshiro256ssFillUint64,
+	.FillBytes =	Xoshiro256ssFillBytes,
+	.Discard =	Xoshiro256ssDiscard,
+	.JumpNew =	Xoshiro256ssJumpNew,
+	.Jump =		Xoshiro256ssJump,
+	.JumpFree =	DiscardJumpFree,
+};
+
+/* Philox4x32-10, "philox4x32" engine. */
+
+static void Philox4x32Seed(void *ctx, uint64_t seed)
+{	philox4x32_seed((philox4x32_ctx *)ctx, seed);
+}
+
+static uint32_t Philox4x32Next32(void *ctx)
+{	return philox4x32_next32((philox4x32_ctx *)ctx);
+}
+
+static uint64_t Philox4x32Next64(void *ctx)
+{	uint64_t	r;
+
+	r = ((uint64_t)philox4x32_next32((philox4x32_ctx *)ctx)) << 32;
+	r |= philox4x32_next32((philox4x32_ctx *)ctx);
+	return r;
+}
+
+static void Philox4x32FillUint32(void *ctx, uint32_t *dst, size_t n)
+{	philox4x32_fill_uint32((philox4x32_ctx *)ctx, dst, n);
+}
+
+static void Philox4x32FillUint64(void *ctx, uint64_t *dst, size_t n)
+{	uint32_t	w[PRNG_ENGINE_COMBINE_WORDS * 2];
+	size_t		m;
+	size_t		i;
+
+	while (n) {
+		m = n;
+		if (m > PRNG_ENGINE_COMBINE_WORDS) {
+			m = PRNG_ENGINE_COMBINE_WORDS;
+		}
+		philox4x32_fill_uint32((philox4x32_ctx *)ctx, w, m * 2);
+		for (i = 0; i < m; i++) {
+			dst[i] = (((uint64_t)w[i * 2]) << 32) | w[i * 2 + 1];
+		}
+		dst += m;
+		n -= m;
+	}
+}
+
+static void Philox4x32FillBytes(void *ctx, uint8_t *dst, size_t n)
+{	philox4x32_fill_uint8((philox4x32_ctx *)ctx, dst, n);
+}
+
+/* @note Constant time, moves counter. */
+static void Philox4x32Discard(void *ctx, uint64_t draws)
+{	philox4x32_discard((philox4x32_ctx *)ctx, draws);
+}
+
+static void Philox4x32Jump(void *ctx, const void *jump)
+{	philox4x32_discard((philox4x32_ctx *)ctx, *(const uint64_t *)jump);
+}
+
+const PrngEngineOps PrngEnginePhilox4x32 = {
+	.Name =		"philox4x32",
+	.Description =	"Philox4x32-10 counter-based, 32 bits per draw, O(1) discard",
+	.ContextSize =	sizeof(philox4x32_ctx),
+	.DrawBits =	32,
+	.Seed =		Philox4x32Seed,
+	.Next32 =	Philox4x32Next32,
+	.Next64 =	Philox4x32Next64,
+	.FillUint32 =	Philox4x32FillUint32,
+	.FillUint64 =	Philox4x32FillUint64,
+	.FillBytes =	Philox4x32FillBytes,
+	.Discard =	Philox4x32Discard,
+	.JumpNew =	DiscardJumpNew,
+	.Jump =		Philox4x32Jump,
+	.JumpFree =	DiscardJumpFree,
+};
+
+const PrngEngineOps *const PrngEngines[] = {
+	&PrngEngineMt19937ar,
+	&PrngEngineMt64,
+	&PrngEngineXoshiro256ss,
+	&PrngEnginePhilox4x32,
+	NULL,
+};
+
+/*! Find engine by name.
+ *  @param name engine name, NULL means the default engine.
+ *  @return const PrngEngineOps * engine, NULL if not found.
+ */
+const PrngEngineOps *PrngEngineFind(const char *name)
+{	const PrngEngineOps *const	*e;
+
+	if (name == NULL) {
+		return PrngEngines[0];
+	}
+	for (e = &(PrngEngines[0]); *e != NULL; e++) {
+		if (strcmp((*e)->Name, name) == 0) {
+			return *e;
+		}
+	}
+	return NULL;
+}
+
+/*! Print engine list in help message format.
+ *  @param fp points stream to print.
+ *  @param argv0 program name, prefix of each line.
+ */
+void PrngEngineHelp(FILE *fp, const char *argv0)
+{	const PrngEngineOps *const	*e;
+
+	for (e = &(PrngEngines[0]); *e != NULL; e++) {
+		fprintf(fp, "%s: HELP:   %s: %s\n",
+			argv0, (*e)->Name, (*e)->Description
+		);
+	}
+}
+
+/*! Fill array with 32 bits integers in [0, range).
+ *  @param pe points engine instance.
+ *  @param dst points array to fill.
+ *  @param n the number of elements to fill.
+ *  @param range the number of values, 0 means 2^32.
+ *  @note dst[] is same sequence as calling PrngEngineBounded32() n times,
+ *        rejected draws are consumed in the same order.
+ */
+void PrngEngineFillBounded32(PrngEngine *pe, uint32_t *dst, size_t n, uint32_t range)
+{	uint32_t	w[PRNG_ENGINE_COMBINE_WORDS];
+	uint32_t	threshold;
+	uint64_t	m;
+	size_t		draws;
+	size_t		i;
+
+	if (range == 0) {
+		PrngEngineFillUint32(pe, dst, n);
+		return;
+	}
+	/* 2^32 mod range, draws below it are rejected. */
+	threshold = (0U - range) % range;
+	while (n) {
+		draws = n;
+		if (draws > PRNG_ENGINE_COMBINE_WORDS) {
+			draws = PRNG_ENGINE_COMBINE_WORDS;
+		}
+		PrngEngineFillUint32(pe, w, draws);
+		for (i = 0; i < draws; i++) {
+			m = (uint64_t)w[i] * range;
+			if ((uint32_t)m < threshold) {
+				continue;
+			}
+			*dst = (uint32_t)(m >> 32);
+			dst++;
+			n--;
+		}
+	}
+}
+
+/*! Fill array with 64 bits integers in [0, range).
+ *  @param pe points engine instance.
+ *  @param dst points array to fill.
+ *  @param n the number of elements to fill.
+ *  @param range the number of values, 0 means 2^64.
+ *  @note dst[] is same sequence as calling PrngEngineBounded64() n times.
+ */
+void PrngEngineFillBounded64(PrngEngine *pe, uint64_t *dst, size_t n, uint64_t range)
+{	uint64_t	w[PRNG_ENGINE_COMBINE_WORDS];
+	uint64_t	threshold;
+	uint64_t	hi;
+	uint64_t	lo;
+	size_t		draws;
+	size_t		i;
+
+	if (range == 0) {
+		PrngEngineFillUint64(pe, dst, n);
+		return;
+	}
+	threshold = (0ULL - range) % range;
+	while (n) {
+		draws = n;
+		if (draws > PRNG_ENGINE_COMBINE_WORDS) {
+			draws = PRNG_ENGINE_COMBINE_WORDS;
+		}
+		PrngEngineFillUint64(pe, w, draws);
+		for (i = 0; i < draws; i++) {
+			hi = PrngEngineMulHi64(w[i], range, &lo);
+			if (lo < threshold) {
+				continue;
+			}
+			*dst = hi;
+			dst++;
+			n--;
+		}
+	}
+}
+
+/*! Initialize engine instance, allocate context.
+ *  @param pe points engine instance.
+ *  @param ops points engine operations.
+ *  @return bool true: success, false: can not allocate context.
+ *  @note Seed engine by PrngEngineSeed() before drawing.
+ */
+bool PrngEngineInit(PrngEngine *pe, const PrngEngineOps *ops)
+{	void	*ctx = NULL;
+	size_t	size;
+
+	pe->Ops = ops;
+	pe->Context = NULL;
+	/* Round up to alignment, contexts never share a cache line. */
+	size = (ops->ContextSize + PRNG_ENGINE_CONTEXT_ALIGN - 1)
+		& ~((size_t)(PRNG_ENGINE_CONTEXT_ALIGN - 1));
+	if (posix_memalign(&ctx, PRNG_ENGINE_CONTEXT_ALIGN, size) != 0) {
+		return false;
+	}
+	memset(ctx, 0, size);
+	pe->Context = ctx;
+	return true;
+}
+
+/*! Free engine instance.
+ *  @param pe points engine instance.
+ */
+void PrngEngineFree(PrngEngine *pe)
+{	free(pe->Context);
+	pe->Context = NULL;
+}
@@ -0,0 +1,191 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* Pseudo random number generator engine interface.
+ * Tools draw numbers through PrngEngine, so an engine is selectable
+ * at run time. MT19937 ("mt19937ar") is the default engine.
+ */
+#if (!defined(PRNG_ENGINE_H))
+#define PRNG_ENGINE_H
+#include <stddef.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*! Engine operations, one instance per engine. */
+typedef struct {
+	const char	*Name;		/*!< Engine name to select. */
+	const char	*Description;	/*!< One line description. */
+	size_t		ContextSize;	/*!< Size of engine context. */
+	unsigned int	DrawBits;	/*!< Bits per draw, 32 or 64. */
+	/*! Initialize context with seed. */
+	void		(*Seed)(void *ctx, uint64_t seed);
+	/*! Draw 32 bits, a draw of 64 bit engine gives upper 32 bits. */
+	uint32_t	(*Next32)(void *ctx);
+	/*! Draw 64 bits, 32 bit engine gives 1st draw in upper 32 bits. */
+	uint64_t	(*Next64)(void *ctx);
+	/*! Fill dst[n], same as calling Next32 n times. */
+	void		(*FillUint32)(void *ctx, uint32_t *dst, size_t n);
+	/*! Fill dst[n], same as calling Next64 n times. */
+	void		(*FillUint64)(void *ctx, uint64_t *dst, size_t n);
+	/*! Fill dst[n] with least significant 8 bits of n draws. */
+	void		(*FillBytes)(void *ctx, uint8_t *dst, size_t n);
+	/*! Skip draws, cost depends on engine. */
+	void		(*Discard)(void *ctx, uint64_t draws);
+	/*! Prepare skipping draws, to apply many times or to many contexts.
+	 *  @return void * prepared jump, NULL if can not allocate.
+	 */
+	void		*(*JumpNew)(uint64_t draws);
+	/*! Skip draws by prepared jump, same as Discard(). */
+	void		(*Jump)(void *ctx, const void *jump);
+	/*! Free prepared jump. */
+	void		(*JumpFree)(void *jump);
+} PrngEngineOps;
+
+/*! Engine instance. */
+typedef struct {
+	const PrngEngineOps	*Ops;
+	void			*Context;
+} PrngEngine;
+
+extern const PrngEngineOps PrngEngineMt19937ar;
+extern const PrngEngineOps PrngEngineMt64;
+extern const PrngEngineOps PrngEngineXoshiro256ss;
+extern const PrngEngineOps PrngEnginePhilox4x32;
+
+/*! Engines, NULL terminated, the first one is the default. */
+extern const PrngEngineOps *const PrngEngines[];
+
+const PrngEngineOps *PrngEngineFind(const char *name);
+void PrngEngineHelp(FILE *fp, const char *argv0);
+bool PrngEngineInit(PrngEngine *pe, const PrngEngineOps *ops);
+void PrngEngineFree(PrngEngine *pe);
+void PrngEngineFillBounded32(PrngEngine *pe, uint32_t *dst, size_t n, uint32_t range);
+void PrngEngineFillBounded64(PrngEngine *pe, uint64_t *dst, size_t n, uint64_t range);
+
+static inline void PrngEngineSeed(PrngEngine *pe, uint64_t seed)
+{	pe->Ops->Seed(pe->Context, seed);
+}
+
+static inline uint32_t PrngEngineNext32(PrngEngine *pe)
+{	return pe->Ops->Next32(pe->Context);
+}
+
+static inline uint64_t PrngEngineNext64(PrngEngine *pe)
+{	return pe->Ops->Next64(pe->Context);
+}
+
+/*! Generates a random number on [0,1)-real-interval.
+ *  @note Same as genrand_real2() with "mt19937ar" engine.
+ */
+static inline double PrngEngineReal2(PrngEngine *pe)
+{	return pe->Ops->Next32(pe->Context) * (1.0/4294967296.0);
+}
+
+static inline void PrngEngineFillUint32(PrngEngine *pe, uint32_t *dst, size_t n)
+{	pe->Ops->FillUint32(pe->Context, dst, n);
+}
+
+static inline void PrngEngineFillUint64(PrngEngine *pe, uint64_t *dst, size_t n)
+{	pe->Ops->FillUint64(pe->Context, dst, n);
+}
+
+static inline void PrngEngineFillBytes(PrngEngine *pe, uint8_t *dst, size_t n)
+{	pe->Ops->FillBytes(pe->Context, dst, n);
+}
+
+static inline void PrngEngineDiscard(PrngEngine *pe, uint64_t draws)
+{	pe->Ops->Discard(pe->Context, draws);
+}
+
+static inline void *PrngEngineJumpNew(const PrngEngineOps *ops, uint64_t draws)
+{	return ops->JumpNew(draws);
+}
+
+static inline void PrngEngineJump(PrngEngine *pe, const void *jump)
+{	pe->Ops->Jump(pe->Context, jump);
+}
+
+static inline void PrngEngineJumpFree(const PrngEngineOps *ops, void *jump)
+{	ops->JumpFree(jump);
+}
+
+/* Bounded integer sampling, multiply high with rejection
+ * (D. Lemire, "Fast Random Integer Generation in an Interval", 2019).
+ * Unbiased, no division unless a draw falls in the biased zone.
+ */
+
+/*! Upper 64 bits of 128 bit product. */
+static inline uint64_t PrngEngineMulHi64(uint64_t a, uint64_t b, uint64_t *lo)
+{
+#if (defined(__SIZEOF_INT128__))
+	unsigned __int128	m;
+
+	m = (unsigned __int128)a * b;
+	*lo = (uint64_t)m;
+	return (uint64_t)(m >> 64);
+#else
+	uint64_t	al, ah, bl, bh;
+	uint64_t	ll, lh, hl, hh;
+	uint64_t	mid;
+
+	al = (uint32_t)a;
+	ah = a >> 32;
+	bl = (uint32_t)b;
+	bh = b >> 32;
+	ll = al * bl;
+	lh = al * bh;
+	hl = ah * bl;
+	hh = ah * bh;
+	mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+	*lo = (mid << 32) | (uint32_t)ll;
+	return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif /* (defined(__SIZEOF_INT128__)) */
+}
+
+/*! Draw 32 bits integer in [0, range).
+ *  @param pe points engine instance.
+ *  @param range the number of values, 0 means 2^32.
+ *  @return uint32_t drawn value.
+ */
+static inline uint32_t PrngEngineBounded32(PrngEngine *pe, uint32_t range)
+{	uint64_t	m;
+	uint32_t	threshold;
+
+	if (range == 0) {
+		return PrngEngineNext32(pe);
+	}
+	m = (uint64_t)PrngEngineNext32(pe) * range;
+	if ((uint32_t)m < range) {
+		/* 2^32 mod range */
+		threshold = (0U - range) % range;
+		while ((uint32_t)m < threshold) {
+			m = (uint64_t)PrngEngineNext32(pe) * range;
+		}
+	}
+	return (uint32_t)(m >> 32);
+}
+
+/*! Draw 64 bits integer in [0, range).
+ *  @param pe points engine instance.
+ *  @param range the number of values, 0 means 2^64.
+ *  @return uint64_t drawn value.
+ */
+static inline uint64_t PrngEngineBounded64(PrngEngine *pe, uint64_t range)
+{	uint64_t	hi;
+	uint64_t	lo;
+	uint64_t	threshold;
+
+	if (range == 0) {
+		return PrngEngineNext64(pe);
+	}
+	hi = PrngEngineMulHi64(PrngEngineNext64(pe), range, &lo);
+	if (lo < range) {
+		/* 2^64 mod range */
+		threshold = (0ULL - range) % range;
+		while (lo < threshold) {
+			hi = PrngEngineMulHi64(PrngEngineNext64(pe), range, &lo);
+		}
+	}
+	return hi;
+}
+
+#endif /* (!defined(PRNG_ENGINE_H)) */
@@ -0,0 +1,209 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* xoshiro256** 1.0, 64 bit all-purpose pseudo random number generator.
+ * Algorithm by David Blackman and Sebastiano Vigna (2018),
+ * see https://prng.di.unimi.it/
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "xoshiro256ss.h"
+
+static inline uint64_t rotl(const uint64_t x, int k)
+{	return (x << k) | (x >> (64 - k));
+}
+
+/*! splitmix64 step, expands seed into state words.
+    @param x points splitmix64 state.
+    @return uint64_t next output.
+*/
+static inline uint64_t splitmix64_next(uint64_t *x)
+{	uint64_t	z;
+
+	z = (*x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/*! initializes ctx from 64 bit seed
+    @param ctx points context.
+    @param seed random seed, any value including zero.
+*/
+void xoshiro256ss_seed(xoshiro256ss_ctx *ctx, uint64_t seed)
+{	uint64_t	x;
+
+	x = seed;
+	ctx->s[0] = splitmix64_next(&x);
+	ctx->s[1] = splitmix64_next(&x);
+	ctx->s[2] = splitmix64_next(&x);
+	ctx->s[3] = splitmix64_next(&x);
+}
+
+/*! generates a random number on [0,0xffffffffffffffff]-interval
+    @param ctx points context.
+    @return uint64_t generated random number.
+*/
+uint64_t xoshiro256ss_next64(xoshiro256ss_ctx *ctx)
+{	uint64_t	*s = ctx->s;
+	uint64_t	result;
+	uint64_t	t;
+
+	result = rotl(s[1] * 5, 7) * 9;
+	t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+	return result;
+}
+
+/*! fills array with random numbers
+    @param ctx points context.
+    @param dst points array to fill.
+    @param n the number of elements to fill.
+*/
+void xoshiro256ss_fill_uint64(xoshiro256ss_ctx *ctx, uint64_t *dst, size_t n)
+{	xoshiro256ss_ctx	c;
+	size_t			i;
+
+	/* Keep state in registers. */
+	c = *ctx;
+	for (i = 0; i < n; i++) {
+		dst[i] = xoshiro256ss_next64(&c);
+	}
+	*ctx = c;
+}
+
+/*! fills array with least significant 8 bits of random numbers
+    @param ctx points context.
+    @param dst points array to fill.
+    @param n the number of bytes to fill.
+*/
+void xoshiro256ss_fill_uint8(xoshiro256ss_ctx *ctx, uint8_t *dst, size_t n)
+{	xoshiro256ss_ctx	c;
+	size_t			i;
+
+	c = *ctx;
+	for (i = 0; i < n; i++) {
+		dst[i] = (uint8_t)xoshiro256ss_next64(&c);
+	}
+	*ctx = c;
+}
+
+/* Jump ahead, any number of draws.
+   State transition A is linear over GF(2). Let phi(x) be its
+   characteristic polynomial and q(x) = x^k mod phi(x), then
+   A^k = q(A). q(A) s is the sum of states 0 .. 255 draws ahead
+   weighted by coefficients of q(x), it costs 256 steps.
+   The fixed jump() of the reference implementation is the case
+   k = 2^128.
+*/
+
+/*! phi(x) without x^256 term, bit i is coefficient of x^i.
+    @note computed by Berlekamp-Massey algorithm from 512 bits of s[0].
+*/
+static const uint64_t xoshiro256ss_phi[4] = {
+	0x9d116f2bb0f0f001ULL, 0x0280002bcefd1a5eULL,
+	0x04b4edcf26259f85ULL, 0x0003c03c3f3ecb19ULL,
+};
+
+/*! multiplies a(x) by x modulo phi(x) */
+static inline void jump_poly_mul_x(uint64_t *a)
+{	uint64_t	top;
+
+	top = a[3] >> 63;
+	a[3] = (a[3] << 1) | (a[2] >> 63);
+	a[2] = (a[2] << 1) | (a[1] >> 63);
+	a[1] = (a[1] << 1) | (a[0] >> 63);
+	a[0] <<= 1;
+	if (top) {
+		a[0] ^= xoshiro256ss_phi[0];
+		a[1] ^= xoshiro256ss_phi[1];
+		a[2] ^= xoshiro256ss_phi[2];
+		a[3] ^= xoshiro256ss_phi[3];
+	}
+}
+
+/*! squares a(x) modulo phi(x) */
+static void jump_poly_square(uint64_t *a)
+{	uint64_t	r[4] = {0, 0, 0, 0};
+	int		i;
+
+	for (i = 255; i >= 0; i--) {
+		jump_poly_mul_x(r);
+		if ((a[i / 64] >> (i % 64)) & 0x1) {
+			r[0] ^= a[0];
+			r[1] ^= a[1];
+			r[2] ^= a[2];
+			r[3] ^= a[3];
+		}
+	}
+	memcpy(a, r, sizeof(r));
+}
+
+/*! prepares jump ahead by draws
+    @param jp points jump to prepare.
+    @param draws the number of draws to jump ahead.
+    @note jp can be applied to any number of contexts.
+*/
+void xoshiro256ss_jump_prepare(xoshiro256ss_jump *jp, uint64_t draws)
+{	int	bit;
+
+	jp->draws = draws;
+	memset(jp->poly, 0, sizeof(jp->poly));
+	if (draws <= XOSHIRO256SS_JUMP_DIRECT_DRAWS) {
+		return;
+	}
+	jp->poly[0] = 1;
+	for (bit = 63; bit >= 0; bit--) {
+		jump_poly_square(jp->poly);
+		if ((draws >> bit) & 0x1) {
+			jump_poly_mul_x(jp->poly);
+		}
+	}
+}
+
+/*! jumps ahead ctx by prepared jump
+    @param ctx points context.
+    @param jp points prepared jump.
+    @note after jump, ctx generates the same numbers as skipping
+          jp->draws numbers by xoshiro256ss_next64().
+*/
+void xoshiro256ss_jump_apply(xoshiro256ss_ctx *ctx, const xoshiro256ss_jump *jp)
+{	xoshiro256ss_ctx	c;
+	uint64_t		t[4] = {0, 0, 0, 0};
+	uint64_t		n;
+	int			i;
+
+	c = *ctx;
+	if (jp->draws <= XOSHIRO256SS_JUMP_DIRECT_DRAWS) {
+		for (n = jp->draws; n > 0; n--) {
+			(void)xoshiro256ss_next64(&c);
+		}
+		*ctx = c;
+		return;
+	}
+	for (i = 0; i < 256; i++) {
+		if ((jp->poly[i / 64] >> (i % 64)) & 0x1) {
+			t[0] ^= c.s[0];
+			t[1] ^= c.s[1];
+			t[2] ^= c.s[2];
+			t[3] ^= c.s[3];
+		}
+		(void)xoshiro256ss_next64(&c);
+	}
+	memcpy(ctx->s, t, sizeof(t));
+}
+
+/*! skips draws numbers
+    @param ctx points context.
+    @param draws the number of draws to skip.
+*/
+void xoshiro256ss_discard(xoshiro256ss_ctx *ctx, uint64_t draws)
+{	xoshiro256ss_jump	jp;
+
+	xoshiro256ss_jump_prepare(&jp, draws);
+	xoshiro256ss_jump_apply(ctx, &jp);
+}
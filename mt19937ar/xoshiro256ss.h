@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* xoshiro256** 1.0, 64 bit all-purpose pseudo random number generator.
+ * Algorithm by David Blackman and Sebastiano Vigna (2018),
+ * see https://prng.di.unimi.it/
+ * Not compatible with MT19937, much cheaper per 64 bits.
+ */
+#if (!defined(XOSHIRO256SS_H))
+#define XOSHIRO256SS_H
+#include <stddef.h>
+#include <stdint.h>
+
+/*! xoshiro256** generator state (context). */
+typedef struct xoshiro256ss_ctx {
+	uint64_t	s[4];	/*!< state, must not be all zero */
+} xoshiro256ss_ctx;
+
+/* initializes ctx from 64 bit seed, state is expanded by splitmix64 */
+void xoshiro256ss_seed(xoshiro256ss_ctx *ctx, uint64_t seed);
+
+/* generates a random number on [0,0xffffffffffffffff]-interval */
+uint64_t xoshiro256ss_next64(xoshiro256ss_ctx *ctx);
+
+/* fills dst[n] with random numbers, same as calling next64 n times */
+void xoshiro256ss_fill_uint64(xoshiro256ss_ctx *ctx, uint64_t *dst, size_t n);
+
+/* fills dst[n] with least significant 8 bits of random numbers */
+void xoshiro256ss_fill_uint8(xoshiro256ss_ctx *ctx, uint8_t *dst, size_t n);
+
+/* Jump ahead functions. */
+
+/*! jumps up to this number of draws step directly */
+#define	XOSHIRO256SS_JUMP_DIRECT_DRAWS	(1024)
+
+/*! Prepared jump, x^draws mod phi(x) */
+typedef struct xoshiro256ss_jump {
+	uint64_t	draws;		/*!< the number of draws to jump ahead */
+	uint64_t	poly[4];	/*!< jump polynomial, bit i is x^i */
+} xoshiro256ss_jump;
+
+/* prepares jump ahead by draws, may be applied to many contexts */
+void xoshiro256ss_jump_prepare(xoshiro256ss_jump *jp, uint64_t draws);
+
+/* jumps ahead ctx by prepared jump */
+void xoshiro256ss_jump_apply(xoshiro256ss_ctx *ctx, const xoshiro256ss_jump *jp);
+
+/* skips draws numbers, by jump ahead when draws are many */
+void xoshiro256ss_discard(xoshiro256ss_ctx *ctx, uint64_t draws);
+
+#endif /* (!defined(XOSHIRO256SS_H)) */
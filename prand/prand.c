@@ -10,7 +10,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <signal.h>
+#include <time.h>
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+#define	PRAND_B64_X86
+#include <immintrin.h>
+#endif
 #include "../mt19937ar/mt19937ar.h"
+#include "../mt19937ar/prng-engine.h"
 #define GETOPT_ALT_TAKEOVER
 #include "../getopt/getopt-alt.h"
 
@@ -36,38 +51,191 @@ FILE	*fpError = NULL;
 
 const char HelpMessage[] =
 	"%s: HELP: Write pseudo random byte(s) to stdout.\n"
-	"%s: HELP: prand [-v] [-s seed_value] bytes_to_output\n"
+	"%s: HELP: prand [-v] [-s seed_value] [-e engine] [-O offset] [-B min:max] [-j threads] [-p] [-W backend] [-f format] [-r min:max] [-o path [-D]] [-T] bytes_to_output\n"
+	"%s: HELP: prand [-v] -S socket_path\n"
+	"%s: HELP: prand [options] -m manifest\n"
 	"%s: HELP: -v: Debug.\n"
 	"%s: HELP: -s seed_value: Unsigned integer pseudo random seed value.\n"
+	"%s: HELP: -O offset: Start output at byte offset of stream, output the same bytes\n"
+	"%s: HELP:    as the range [offset, offset + bytes_to_output) of the whole stream.\n"
+	"%s: HELP:    philox4x32 seeks in constant time, others jump ahead.\n"
+	"%s: HELP: -B min:max: Output bytes_to_output unsigned integers in [min, max]\n"
+	"%s: HELP:    in decimal, one per line, drawn by unbiased bounded sampling.\n"
+	"%s: HELP:    -O offset counts draws of engine (32 or 64 bits), not bytes.\n"
+	"%s: HELP:    Can not use with -j, -p, -W, -f, -r and -D.\n"
+	"%s: HELP: -j threads: Generate bytes by threads, output is the same as single thread.\n"
+	"%s: HELP: -p: Packed output, write all bytes of each draw (4 bytes per draw of\n"
+	"%s: HELP:    32 bit engines, 8 bytes of 64 bit engines) in little endian order.\n"
+	"%s: HELP:    Default (legacy) output writes least significant byte of each draw.\n"
+	"%s: HELP: -W backend: Output backend, one of followings (default auto).\n"
+	"%s: HELP:    stdio: fwrite(). write: write() large aligned buffers to stdout.\n"
+	"%s: HELP:    vmsplice: vmsplice() buffers into pipe, stdout should be a pipe.\n"
+	"%s: HELP:    Gifts pages of fresh buffers to pipe, only when asked explicitly.\n"
+	"%s: HELP:    auto: Same as write.\n"
+	"%s: HELP: -f format: Output format, one of followings (default bin).\n"
+	"%s: HELP:    bin: Binary bytes.\n"
+	"%s: HELP:    b64: bytes_to_output characters of base64 with '_' for '/', and newline.\n"
+	"%s: HELP:    Same as \"prand N*3/4 | base64 | tr '/' '_' | tr -d '\\n' | cut -c 1-N\",\n"
+	"%s: HELP:    N*3/4 rounded up to multiple of 3. -j is ignored.\n"
+	"%s: HELP:    dec, hex: bytes_to_output 64 bit unsigned integers, one per line, in\n"
+	"%s: HELP:    decimal or in hex as 0x%%016x. Each is made from 8 bytes in little endian.\n"
+	"%s: HELP: -r min:max: Map -f dec, hex values into [min, max] by\n"
+	"%s: HELP:    floor(min + (max - min + 1) * value / 2^64).\n"
+	"%s: HELP: -o path: Output to file path instead of stdout, preallocate its blocks.\n"
+	"%s: HELP: -D: Write file with O_DIRECT (bypass page cache), -W write (or auto) only.\n"
+	"%s: HELP: -T: Show statistics, bytes, throughput, time of phases (generate,\n"
+	"%s: HELP:    encode, write, wait for threads), short writes, EINTRs and write\n"
+	"%s: HELP:    latency percentiles, as one JSON line to error output at exit.\n"
+	"%s: HELP: -m manifest: Create files listed in manifest (\"-\": stdin), a line is\n"
+	"%s: HELP:    \"seed bytes_to_output path\". Same as \"prand -s seed -o path bytes_to_output\"\n"
+	"%s: HELP:    with other options, for each line. Empty lines and lines start with '#'\n"
+	"%s: HELP:    are skipped. Stops at first error.\n"
+	"%s: HELP: -S socket_path: Serve requests on unix domain socket, see prandc.\n"
+	"%s: HELP:    A request is prand options and bytes_to_output, each followed by LF,\n"
+	"%s: HELP:    ends with empty line. Reply is \"OK\" LF and output in frames, each is\n"
+	"%s: HELP:    length in hex, LF and bytes. Empty frame \"0\" LF ends output, then\n"
+	"%s: HELP:    \"OK\" or \"ERROR\" LF and messages. Bad request is replied \"ERROR\" LF\n"
+	"%s: HELP:    and messages. Requests are served one by one, a client stalls over\n"
+	"%s: HELP:    10 seconds is dropped. -o path should be absolute, -m and -V are not\n"
+	"%s: HELP:    allowed. SIGINT or SIGTERM stops server, shows latency statistics.\n"
 	"%s: HELP: -V debug_switch: e: Output error messages to stdout.\n"
+	"%s: HELP: -e engine: Pseudo random number generator engine, one of followings.\n"
 	;
 
+/*! Output backends. */
+typedef enum {
+	PRAND_OUTPUT_AUTO = 0,
+	PRAND_OUTPUT_STDIO,
+	PRAND_OUTPUT_WRITE,
+	PRAND_OUTPUT_VMSPLICE,
+} PrandOutputMode;
+
+const char *const PrandOutputNames[] = {
+	[PRAND_OUTPUT_AUTO] =		"auto",
+	[PRAND_OUTPUT_STDIO] =		"stdio",
+	[PRAND_OUTPUT_WRITE] =		"write",
+	[PRAND_OUTPUT_VMSPLICE] =	"vmsplice",
+};
+
+/*! Output formats. */
+typedef enum {
+	PRAND_FORMAT_BIN = 0,
+	PRAND_FORMAT_B64,
+	PRAND_FORMAT_DEC,
+	PRAND_FORMAT_HEX,
+} PrandFormat;
+
+const char *const PrandFormatNames[] = {
+	[PRAND_FORMAT_BIN] =	"bin",
+	[PRAND_FORMAT_B64] =	"b64",
+	[PRAND_FORMAT_DEC] =	"dec",
+	[PRAND_FORMAT_HEX] =	"hex",
+};
+
 typedef struct {
 	bool		Debug;
 	bool		Help;
 	char		*Argv0;
 	unsigned long	Seed;
+	const PrngEngineOps	*Engine;
+	uint64_t	Offset;
+	bool		Bounded;
+	uint64_t	BoundedMin;
+	uint64_t	BoundedRange;	/* 0 means 2^64. */
+	long		Threads;
+	bool		Packed;
+	PrandOutputMode	Output;
+	PrandFormat	Format;
+	bool		Mapped;
+	uint64_t	MappedMin;
+	uint64_t	MappedRange;	/*!< 0: 2^64 values. */
+	const char	*OutputPath;
+	bool		Direct;
+	const char	*ServePath;
+	const char	*Manifest;
+	bool		Stats;
 	ssize_t		Length;
 } CCommandLine;
 
-CCommandLine	CommandLine = {
+const CCommandLine	CCommandLineDefault = {
 	.Debug =	false,
 	.Help =		false,
 	.Seed = 0,
+	.Engine = NULL,
+	.Offset = 0,
+	.Bounded = false,
+	.BoundedMin = 0,
+	.BoundedRange = 0,
+	.Threads = 1,
+	.Packed = false,
+	.Output = PRAND_OUTPUT_AUTO,
+	.Format = PRAND_FORMAT_BIN,
+	.Mapped = false,
+	.MappedMin = 0,
+	.MappedRange = 0,
+	.OutputPath = NULL,
+	.Direct = false,
+	.ServePath = NULL,
+	.Manifest = NULL,
+	.Stats = false,
 	.Length = 0,
 };
 
+CCommandLine	CommandLine;
+
+/*! Maximum number of generator threads. */
+#define	PRAND_THREADS_MAX	(256)
+
+/* Parse "min:max" into min and the number of values.
+ * @return bool true: success, false: syntax error.
+ */
+bool CCommandLineParseRange(CCommandLine *cmdl, const char *arg, uint64_t *min, uint64_t *range)
+{	unsigned long long	lo;
+	unsigned long long	hi;
+	const char		*p;
+	char			*p2;
+
+	p = arg;
+	errno = 0;
+	lo = strtoull(p, &p2, 0);
+	if ((p2 == p) || (*p2 != ':') || (*p == '-') || (errno != 0)) {
+		goto err;
+	}
+	p = p2 + 1;
+	hi = strtoull(p, &p2, 0);
+	if ((p2 == p) || (*p2 != 0) || (*p == '-') || (errno != 0)) {
+		goto err;
+	}
+	if (lo > hi) {
+		fprintf(fpError, "%s: ERROR: Minimum is greater than maximum. range=\"%s\"\n",
+			cmdl->Argv0, arg
+		);
+		return false;
+	}
+	*min = lo;
+	*range = (uint64_t)(hi - lo) + 1;
+	return true;
+err:
+	fprintf(fpError, "%s: ERROR: Specify range as min:max in unsigned integers. range=\"%s\"\n",
+		cmdl->Argv0, arg
+	);
+	return false;
+}
+
 bool CCommandLineParse(CCommandLine *cmdl, int argc, char **argv)
 {	int	result = true;
 	int	opt;
 	long		lval;
 	unsigned long	ulval;
+	unsigned long long	ullval;
+	size_t	i;
 	char	c;
 	char	*p;
 	char	*p2;
 
 	cmdl->Argv0 = argv[0];
-	while ((opt = getopt(argc, argv, "s:vV:h")) != -1) {
+	cmdl->Engine = PrngEngineFind(NULL);
+	while ((opt = getopt(argc, argv, "s:e:O:B:j:pW:f:r:o:DS:m:TvV:h")) != -1) {
 		switch (opt) {
 		case 's':
 			/* Set Random Seed */
@@ -83,6 +251,117 @@ bool CCommandLineParse(CCommandLine *cmdl, int argc, char **argv)
 				cmdl->Seed = ulval;
 			}
 			break;
+		case 'e':
+			/* Set engine */
+			cmdl->Engine = PrngEngineFind(optarg);
+			if (!(cmdl->Engine)) {
+				fprintf(fpError, "%s: ERROR: Unknown engine. engine=\"%s\"\n",
+					cmdl->Argv0, optarg
+				);
+				result = false;
+			}
+			break;
+		case 'O':
+			/* Set offset */
+			p = optarg;
+			p2 = p;
+			errno = 0;
+			ullval = strtoull(p, &p2, 0);
+			if ((p2 == p) || (*p2 != 0) || (errno != 0) || (*p == '-')) {
+				fprintf(fpError, "%s: ERROR: Specify unsigned integer to -O (offset) option.\n",
+					cmdl->Argv0
+				);
+				result = false;
+			} else {
+				cmdl->Offset = ullval;
+			}
+			break;
+		case 'B':
+			/* Set bounded integer range */
+			if (!CCommandLineParseRange(cmdl, optarg,
+				&(cmdl->BoundedMin), &(cmdl->BoundedRange))) {
+				result = false;
+			}
+			cmdl->Bounded = true;
+			break;
+		case 'j':
+			/* Set threads */
+			p = optarg;
+			p2 = p;
+			lval = strtol(p, &p2, 0);
+			if ((p2 == p) || (*p2 != 0) || (lval < 1) || (lval > PRAND_THREADS_MAX)) {
+				fprintf(fpError, "%s: ERROR: Specify 1 to %d to -j (threads) option.\n",
+					cmdl->Argv0, PRAND_THREADS_MAX
+				);
+				result = false;
+			} else {
+				cmdl->Threads = lval;
+			}
+			break;
+		case 'p':
+			/* Set packed output */
+			cmdl->Packed = true;
+			break;
+		case 'W':
+			/* Set output backend */
+			for (i = 0; i < ElementsOf(PrandOutputNames); i++) {
+				if (strcmp(optarg, PrandOutputNames[i]) == 0) {
+					break;
+				}
+			}
+			if (i >= ElementsOf(PrandOutputNames)) {
+				fprintf(fpError, "%s: ERROR: Unknown output backend. backend=\"%s\"\n",
+					cmdl->Argv0, optarg
+				);
+				result = false;
+			} else {
+				cmdl->Output = (PrandOutputMode)i;
+			}
+			break;
+		case 'f':
+			/* Set output format */
+			for (i = 0; i < ElementsOf(PrandFormatNames); i++) {
+				if (strcmp(optarg, PrandFormatNames[i]) == 0) {
+					break;
+				}
+			}
+			if (i >= ElementsOf(PrandFormatNames)) {
+				fprintf(fpError, "%s: ERROR: Unknown output format. format=\"%s\"\n",
+					cmdl->Argv0, optarg
+				);
+				result = false;
+			} else {
+				cmdl->Format = (PrandFormat)i;
+			}
+			break;
+		case 'r':
+			/* Set mapped range */
+			if (!CCommandLineParseRange(cmdl, optarg,
+				&(cmdl->MappedMin), &(cmdl->MappedRange))) {
+				result = false;
+			}
+			cmdl->Mapped = true;
+			break;
+		case 'o':
+			/* Set output file */
+			cmdl->OutputPath = optarg;
+			break;
+		case 'D':
+			/* Set direct I/O */
+			cmdl->Direct = true;
+			break;
+		case 'S':
+			/* Set server socket */
+			cmdl->ServePath = optarg;
+			break;
+		case 'm':
+			/* Set manifest */
+			cmdl->Manifest = optarg;
+			break;
+		case 'T':
+			/* Set statistics */
+			cmdl->Stats = true;
+			break;
 		case 'v':
 			/* Set debug */
 			cmdl->Debug = true;
@@ -109,6 +388,25 @@ bool CCommandLineParse(CCommandLine *cmdl, int argc, char **argv)
 			break;
 		}
 	}
+	if ((cmdl->Mapped) &&
+	    (cmdl->Format != PRAND_FORMAT_DEC) && (cmdl->Format != PRAND_FORMAT_HEX)) {
+		fprintf(fpError, "%s: ERROR: Option -r needs -f dec or -f hex.\n",
+			cmdl->Argv0
+		);
+		result = false;
+	}
+	if ((cmdl->Bounded) &&
+	    ((cmdl->Threads > 1) || (cmdl->Packed) || (cmdl->Output != PRAND_OUTPUT_AUTO) ||
+	     (cmdl->Format != PRAND_FORMAT_BIN) || (cmdl->Mapped) || (cmdl->Direct))) {
+		fprintf(fpError, "%s: ERROR: Option -B can not be used with -j, -p, -W, -f, -r and -D.\n",
+			cmdl->Argv0
+		);
+		result = false;
+	}
+	if (((cmdl->ServePath) || (cmdl->Manifest)) && (optind >= argc)) {
+		/* Server and manifest take bytes to output from requests and lines. */
+		return result;
+	}
 	if (optind >= argc) {
 		fprintf(fpError, "%s: ERROR: Specify bytes to output at 1st argument.\n",
 			cmdl->Argv0
@@ -138,76 +436,2039 @@ bool CCommandLineParse(CCommandLine *cmdl, int argc, char **argv)
 	return result;
 }
 
-bool EmitPesudoRand(CCommandLine *cmdl)
-{	unsigned char	*buf0 = NULL;
-	unsigned char	*p;
-	ssize_t		n;
-	ssize_t		wlen;
-	bool		result = true;
+/*! Output buffer size, generate and write in this unit. */
+#define	PRAND_BUFFER_SIZE	(1024 * 1024)
+/*! Output buffer alignment, a page. */
+#define	PRAND_BUFFER_ALIGN	(4096)
 
-	n = cmdl->Length;
-	buf0 = malloc(n);
-	if (!buf0) {
-		fprintf(fpError, "%s: ERROR: Can not allocate buffer. n=%ld(0x%lx)\n",
-			cmdl->Argv0, (long)n, (long)n
+/*! Draws staged at once, when packed output isn't aligned. */
+#define	PRAND_STAGE_DRAWS	(1024)
+
+/*! Buffers kept for next output, manifest mode creates many files. */
+#define	PRAND_POOL_LENGTH	(16)
+
+typedef struct {
+	void		*Buf;
+	size_t		Size;
+} PrandPoolEntry;
+
+PrandPoolEntry	PrandPool[PRAND_POOL_LENGTH];
+
+/*! Get aligned buffer, from pool if there is.
+ *  @note Not thread safe, call from main thread.
+ *  @return void * buffer, NULL: no memory.
+ */
+void *PrandBufferGet(size_t size)
+{	void	*p;
+	size_t	i;
+
+	for (i = 0; i < PRAND_POOL_LENGTH; i++) {
+		if ((PrandPool[i].Buf) && (PrandPool[i].Size == size)) {
+			p = PrandPool[i].Buf;
+			PrandPool[i].Buf = NULL;
+			return p;
+		}
+	}
+	if (posix_memalign(&p, PRAND_BUFFER_ALIGN, size) != 0) {
+		return NULL;
+	}
+	return p;
+}
+
+/*! Put buffer back to pool. */
+void PrandBufferPut(void *buf, size_t size)
+{	size_t	i;
+
+	if (!buf) {
+		return;
+	}
+	for (i = 0; i < PRAND_POOL_LENGTH; i++) {
+		if (!(PrandPool[i].Buf)) {
+			PrandPool[i].Buf = buf;
+			PrandPool[i].Size = size;
+			return;
+		}
+	}
+	free(buf);
+}
+
+/*! Statistics of a run, -T option.
+ *  Time is in nanoseconds, generation time is summed over threads.
+ */
+typedef struct {
+	bool		Enabled;
+	const char	*Backend;	/*!< Output backend in use. */
+	uint64_t	Start;		/*!< Time at start. */
+	uint64_t	Bytes;		/*!< Bytes written. */
+	uint64_t	GenNs;		/*!< Generating random bytes. */
+	uint64_t	EncodeNs;	/*!< Encoding to text. */
+	uint64_t	WriteNs;	/*!< Writing output. */
+	uint64_t	WaitNs;		/*!< Writer waiting for threads. */
+	uint64_t	Writes;		/*!< Buffers written. */
+	uint64_t	ShortWrites;
+	uint64_t	Interrupts;
+	uint64_t	*Latency;	/*!< Write latency of each buffer. */
+	size_t		LatencyCount;
+	size_t		LatencySize;
+} PrandStats;
+
+PrandStats	Stats;
+
+/*! Monotonic time in nanoseconds. */
+static inline uint64_t PrandNow(void)
+{	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)(ts.tv_sec) * 1000000000ULL + (uint64_t)(ts.tv_nsec);
+}
+
+/*! Start statistics. */
+void PrandStatsBegin(CCommandLine *cmdl)
+{	free(Stats.Latency);
+	memset(&Stats, 0, sizeof(Stats));
+	Stats.Enabled = cmdl->Stats;
+	Stats.Backend = "stdio";
+	Stats.Start = PrandNow();
+}
+
+/*! Record a buffer written. */
+static void PrandStatsWrite(uint64_t ns, size_t bytes)
+{	uint64_t	*p;
+	size_t		size;
+
+	Stats.Bytes += bytes;
+	Stats.WriteNs += ns;
+	Stats.Writes++;
+	if (Stats.LatencyCount >= Stats.LatencySize) {
+		size = Stats.LatencySize * 2;
+		if (size == 0) {
+			size = 1024;
+		}
+		p = realloc(Stats.Latency, size * sizeof(Stats.Latency[0]));
+		if (!p) {
+			/* Drop sample. */
+			return;
+		}
+		Stats.Latency = p;
+		Stats.LatencySize = size;
+	}
+	Stats.Latency[Stats.LatencyCount] = ns;
+	Stats.LatencyCount++;
+}
+
+static int PrandStatsCompare(const void *a, const void *b)
+{	uint64_t	x = *(const uint64_t *)a;
+	uint64_t	y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*! Write latency percentile in microseconds, nearest rank. */
+static double PrandStatsPercentile(double percent)
+{	size_t	i;
+
+	if (Stats.LatencyCount == 0) {
+		return 0.0;
+	}
+	i = (size_t)(percent / 100.0 * (double)(Stats.LatencyCount) + 0.999999);
+	if (i < 1) {
+		i = 1;
+	}
+	if (i > Stats.LatencyCount) {
+		i = Stats.LatencyCount;
+	}
+	return (double)(Stats.Latency[i - 1]) / 1e3;
+}
+
+/*! Show statistics as one JSON line. */
+void PrandStatsEnd(CCommandLine *cmdl)
+{	double	wall;
+
+	if (!(Stats.Enabled)) {
+		return;
+	}
+	wall = (double)(PrandNow() - Stats.Start) / 1e9;
+	qsort(Stats.Latency, Stats.LatencyCount, sizeof(Stats.Latency[0]), PrandStatsCompare);
+	fprintf(fpError,
+		"{\"engine\":\"%s\",\"format\":\"%s\",\"backend\":\"%s\",\"threads\":%ld,"
+		"\"bytes\":%" PRIu64 ",\"wall_s\":%.6f,\"gb_per_s\":%.3f,"
+		"\"gen_s\":%.6f,\"encode_s\":%.6f,\"write_s\":%.6f,\"wait_s\":%.6f,"
+		"\"writes\":%" PRIu64 ",\"short_writes\":%" PRIu64 ",\"eintr\":%" PRIu64 ","
+		"\"write_latency_us\":{\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"max\":%.1f}}\n",
+		cmdl->Engine->Name,
+		(cmdl->Bounded ? "bounded" : PrandFormatNames[cmdl->Format]),
+		Stats.Backend,
+		cmdl->Threads,
+		Stats.Bytes,
+		wall,
+		(wall > 0.0 ? (double)(Stats.Bytes) / wall / 1e9 : 0.0),
+		(double)(Stats.GenNs) / 1e9,
+		(double)(Stats.EncodeNs) / 1e9,
+		(double)(Stats.WriteNs) / 1e9,
+		(double)(Stats.WaitNs) / 1e9,
+		Stats.Writes,
+		Stats.ShortWrites,
+		Stats.Interrupts,
+		PrandStatsPercentile(50.0),
+		PrandStatsPercentile(90.0),
+		PrandStatsPercentile(99.0),
+		PrandStatsPercentile(100.0)
+	);
+	free(Stats.Latency);
+	Stats.Latency = NULL;
+	Stats.LatencyCount = 0;
+	Stats.LatencySize = 0;
+}
+
+/*! Byte stream generator, legacy or packed.
+ *  Legacy: a byte is the least significant 8 bits of a draw.
+ *  Packed: a draw makes DrawBytes bytes in little endian order.
+ */
+typedef struct {
+	PrngEngine	Engine;
+	unsigned int	DrawBytes;	/*!< Bytes per draw, 1 in legacy mode. */
+	uint8_t		Carry[8];	/*!< Bytes of draw partially output. */
+	unsigned int	CarryPos;	/*!< Next byte in Carry[], DrawBytes: empty. */
+} PrandGen;
+
+/*! Load next draw into Carry[] in little endian order. */
+static void PrandGenCarry(PrandGen *g, unsigned int pos)
+{	uint64_t	w;
+	unsigned int	i;
+
+	if (g->DrawBytes == 8) {
+		w = PrngEngineNext64(&(g->Engine));
+	} else {
+		w = PrngEngineNext32(&(g->Engine));
+	}
+	for (i = 0; i < g->DrawBytes; i++) {
+		g->Carry[i] = (uint8_t)(w >> (i * 8));
+	}
+	g->CarryPos = pos;
+}
+
+/*! Initialize generator at byte position.
+ *  @param g points generator.
+ *  @param cmdl points command line, engine, seed and mode.
+ *  @param pos byte position in stream.
+ *  @return bool true: success, false: can not allocate engine.
+ */
+bool PrandGenInit(PrandGen *g, CCommandLine *cmdl, uint64_t pos)
+{	if (!PrngEngineInit(&(g->Engine), cmdl->Engine)) {
+		fprintf(fpError, "%s: ERROR: Can not allocate engine context. engine=%s\n",
+			cmdl->Argv0, cmdl->Engine->Name
 		);
 		return false;
 	}
+	PrngEngineSeed(&(g->Engine), (uint64_t)(cmdl->Seed));
+	g->DrawBytes = 1;
+	if (cmdl->Packed) {
+		g->DrawBytes = cmdl->Engine->DrawBits / 8;
+	}
+	g->CarryPos = g->DrawBytes;
+	PrngEngineDiscard(&(g->Engine), pos / g->DrawBytes);
+	if ((pos % g->DrawBytes) != 0) {
+		PrandGenCarry(g, (unsigned int)(pos % g->DrawBytes));
+	}
+	return true;
+}
+
+void PrandGenFree(PrandGen *g)
+{	PrngEngineFree(&(g->Engine));
+}
+
+/*! Draws to jump over bytes, for PrandGenJump().
+ *  @param g points generator.
+ *  @param bytes bytes to skip, multiple of DrawBytes.
+ *  @return uint64_t draws to prepare jump.
+ *  @note When a draw is partially output, PrandGenJump() draws it again.
+ */
+uint64_t PrandGenJumpDraws(PrandGen *g, uint64_t bytes)
+{	uint64_t	draws;
+
+	draws = bytes / g->DrawBytes;
+	if (g->CarryPos < g->DrawBytes) {
+		draws--;
+	}
+	return draws;
+}
 
-	init_genrand((uint32_t)(cmdl->Seed));
+/*! Skip bytes by jump prepared for PrandGenJumpDraws() draws. */
+void PrandGenJump(PrandGen *g, const void *jump)
+{	PrngEngineJump(&(g->Engine), jump);
+	if (g->CarryPos < g->DrawBytes) {
+		PrandGenCarry(g, g->CarryPos);
+	}
+}
 
-	p = buf0;
-	while (n) {
-		uint32_t	r32 = 0;
+/*! Fill buffer with next n bytes of stream.
+ *  @param g points generator.
+ *  @param dst points buffer.
+ *  @param n bytes to fill.
+ */
+static void PrandGenFillBytes(PrandGen *g, uint8_t *dst, size_t n)
+{	uint64_t	stage[PRAND_STAGE_DRAWS];
+	unsigned int	db = g->DrawBytes;
+	size_t		draws;
+	size_t		m;
+	size_t		i;
+	unsigned int	k;
 
-		r32 = genrand_uint32();
-		*p = (unsigned char)r32;
-		p++;
+	if (db == 1) {
+		PrngEngineFillBytes(&(g->Engine), dst, n);
+		return;
+	}
+	/* Rest of partially output draw. */
+	while ((n > 0) && (g->CarryPos < db)) {
+		*dst = g->Carry[g->CarryPos];
+		g->CarryPos++;
+		dst++;
 		n--;
 	}
+	draws = n / db;
+#if (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+	if (((uintptr_t)dst % db) == 0) {
+		/* Draws are in little endian order in memory. */
+		if (db == 8) {
+			PrngEngineFillUint64(&(g->Engine), (uint64_t *)dst, draws);
+		} else {
+			PrngEngineFillUint32(&(g->Engine), (uint32_t *)dst, draws);
+		}
+		dst += draws * db;
+		draws = 0;
+	}
+#endif
+	while (draws > 0) {
+		m = draws;
+		if (m > PRAND_STAGE_DRAWS) {
+			m = PRAND_STAGE_DRAWS;
+		}
+		if (db == 8) {
+			PrngEngineFillUint64(&(g->Engine), stage, m);
+			for (i = 0; i < m; i++) {
+				for (k = 0; k < 8; k++) {
+					dst[i * 8 + k] = (uint8_t)(stage[i] >> (k * 8));
+				}
+			}
+		} else {
+			PrngEngineFillUint32(&(g->Engine), (uint32_t *)stage, m);
+			for (i = 0; i < m; i++) {
+				uint32_t	w = ((uint32_t *)stage)[i];
 
-	n = cmdl->Length;
-	wlen = fwrite(buf0, sizeof(buf0[0]), n, stdout);
-	if (wlen != n) {
-		fprintf(fpError, "%s: ERROR: Can not complete fwrite(), %s. wlen=%ld, n=%ld\n",
-			cmdl->Argv0,
-			strerror(errno),
-			(long)(wlen), (long)(n)
+				for (k = 0; k < 4; k++) {
+					dst[i * 4 + k] = (uint8_t)(w >> (k * 8));
+				}
+			}
+		}
+		dst += m * db;
+		draws -= m;
+	}
+	n %= db;
+	if (n > 0) {
+		PrandGenCarry(g, 0);
+		while (n > 0) {
+			*dst = g->Carry[g->CarryPos];
+			g->CarryPos++;
+			dst++;
+			n--;
+		}
+	}
+}
+
+/*! Fill dst with n bytes of stream, counts generation time.
+ *  @note Called from worker threads.
+ */
+void PrandGenFill(PrandGen *g, uint8_t *dst, size_t n)
+{	uint64_t	t0;
+
+	if (!(Stats.Enabled)) {
+		PrandGenFillBytes(g, dst, n);
+		return;
+	}
+	t0 = PrandNow();
+	PrandGenFillBytes(g, dst, n);
+	__atomic_add_fetch(&(Stats.GenNs), PrandNow() - t0, __ATOMIC_RELAXED);
+}
+
+/*! Pipe size to request, when output to pipe. */
+#define	PRAND_PIPE_SIZE		(1024 * 1024)
+
+/*! Raw output to a file descriptor, bypasses stdio.
+ *  vmsplice() gifts buffer pages to the pipe (SPLICE_F_GIFT). Readers
+ *  may splice() the pages onward and refer them at any time later, so
+ *  a gifted buffer is never refilled. It is unmapped and a freshly
+ *  mapped buffer takes its place, see PrandOutputRenew().
+ */
+typedef struct {
+	const char	*Argv0;
+	int		Fd;
+	PrandOutputMode	Mode;		/*!< Resolved, never AUTO. */
+	size_t		PipeSize;	/*!< Pipe capacity, 0 if not a pipe. */
+	uint8_t		**Ring;		/*!< Buffers to fill. */
+	size_t		RingCount;
+	size_t		RingIndex;	/*!< Next buffer. */
+	size_t		BufferSize;
+	bool		Direct;		/*!< O_DIRECT is set to Fd. */
+	uint64_t	Offset;		/*!< File offset to write next. */
+	uint64_t	ShortWrites;	/*!< Partial write() or vmsplice(). */
+	uint64_t	Interrupts;	/*!< EINTR retries. */
+} PrandOutput;
+
+/*! Get a buffer to output by backend.
+ *  @note Not thread safe, call from main thread.
+ *  @return void * buffer, NULL: no memory.
+ */
+static void *PrandOutputAlloc(PrandOutput *o, size_t size)
+{	void	*p;
+
+	if (o->Mode != PRAND_OUTPUT_VMSPLICE) {
+		return PrandBufferGet(size);
+	}
+	/* Page aligned, pages of their own, gifted to pipe. */
+	p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+	);
+	if (p == MAP_FAILED) {
+		return NULL;
+	}
+	return p;
+}
+
+/*! Free a buffer got by PrandOutputAlloc().
+ *  Unmapping a gifted buffer is safe, pipe holds references to its pages.
+ */
+static void PrandOutputFree(PrandOutput *o, void *buf, size_t size)
+{	if (!buf) {
+		return;
+	}
+	if (o->Mode != PRAND_OUTPUT_VMSPLICE) {
+		PrandBufferPut(buf, size);
+		return;
+	}
+	munmap(buf, size);
+}
+
+/*! Renew a buffer before filling it again.
+ *  @return void * buf itself, or fresh buffer instead of gifted one,
+ *          NULL: no memory, buf is freed.
+ */
+static void *PrandOutputRenew(PrandOutput *o, void *buf, size_t size)
+{	void	*p;
+
+	if (o->Mode != PRAND_OUTPUT_VMSPLICE) {
+		return buf;
+	}
+	PrandOutputFree(o, buf, size);
+	p = PrandOutputAlloc(o, size);
+	if (!p) {
+		fprintf(fpError, "%s: ERROR: Can not allocate buffer. n=%ld(0x%lx)\n",
+			o->Argv0, (long)size, (long)size
 		);
-		result = false;
-		goto out;
 	}
-out:
-	free(buf0);
-	return result;
+	return p;
 }
 
-int main(int argc, char **argv, __maybe_unused char **env)
-{	int	result = 0;
-	char	*a0;
+/*! Redirect stdout to file -o path.
+ *  @return bool true: success, false: error.
+ */
+bool PrandOutputRedirect(CCommandLine *cmdl)
+{	int	fd;
 
-	fpError = stderr;
+	fflush(stdout);
+	fd = open(cmdl->OutputPath, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd == INVALID_FD) {
+		fprintf(fpError, "%s: ERROR: Can not open output file, %s. path=\"%s\"\n",
+			cmdl->Argv0, strerror(errno), cmdl->OutputPath
+		);
+		return false;
+	}
+	if (fd != STDOUT_FILENO) {
+		if (dup2(fd, STDOUT_FILENO) < 0) {
+			fprintf(fpError, "%s: ERROR: Can not redirect output, %s. path=\"%s\"\n",
+				cmdl->Argv0, strerror(errno), cmdl->OutputPath
+			);
+			close(fd);
+			return false;
+		}
+		close(fd);
+	}
+	return true;
+}
 
-	a0 = argv[0];
-	if (!CCommandLineParse(&CommandLine, argc, argv) ||
-	    CommandLine.Help) {
-		fprintf(fpError, HelpMessage,
-			a0,
-			a0,
-			a0,
-			a0,
-			a0
+/*! Prepare regular file output, preallocate and set O_DIRECT.
+ *  Preallocation keeps file size, a failed run leaves no zero filled tail.
+ */
+static void PrandOutputOpenFile(PrandOutput *o, CCommandLine *cmdl, uint64_t size)
+{	off_t	offset;
+
+	offset = lseek(o->Fd, 0, SEEK_CUR);
+	if (offset < 0) {
+		offset = 0;
+	}
+	o->Offset = (uint64_t)offset;
+#if (defined(__linux__))
+	if (size > 0) {
+		/* Not supported on some file systems, it's only a hint. */
+		(void)fallocate(o->Fd, FALLOC_FL_KEEP_SIZE, offset, (off_t)size);
+	}
+	if ((cmdl->Direct) && (o->Mode == PRAND_OUTPUT_WRITE)) {
+		int	flags;
+
+		flags = fcntl(o->Fd, F_GETFL);
+		if ((flags >= 0) && (fcntl(o->Fd, F_SETFL, flags | O_DIRECT) == 0)) {
+			o->Direct = true;
+		} else {
+			fprintf(fpError, "%s: WARNING: Can not set O_DIRECT, %s.\n",
+				o->Argv0, strerror(errno)
+			);
+		}
+	}
+#endif /* (defined(__linux__)) */
+	if ((cmdl->Direct) && (!(o->Direct)) && (o->Mode != PRAND_OUTPUT_WRITE)) {
+		fprintf(fpError, "%s: WARNING: O_DIRECT needs -W write, ignored.\n",
+			o->Argv0
 		);
-		return 1;
 	}
-	if (CommandLine.Debug) {
-		fprintf(fpError, "%s: DEBUG: Debug mode. Seed=%ld, Length=%ld\n",
-			a0,
-			(long)(CommandLine.Seed),
-			(long)(CommandLine.Length)
+}
+
+/*! Clear O_DIRECT, to write unaligned tail. */
+static void PrandOutputClearDirect(PrandOutput *o)
+{
+#if (defined(__linux__))
+	int	flags;
+
+	flags = fcntl(o->Fd, F_GETFL);
+	if (flags >= 0) {
+		(void)fcntl(o->Fd, F_SETFL, flags & ~O_DIRECT);
+	}
+#endif /* (defined(__linux__)) */
+	o->Direct = false;
+}
+
+/*! Open output to stdout, resolve backend, allocate buffer ring.
+ *  @param o points output.
+ *  @param cmdl points command line.
+ *  @param buffer_size size of a buffer.
+ *  @param buffers the number of buffers needed by caller at least.
+ *  @param size bytes to output, used to preallocate file, 0: unknown.
+ *  @return bool true: success, false: error.
+ */
+bool PrandOutputOpen(PrandOutput *o, CCommandLine *cmdl, size_t buffer_size, size_t buffers, uint64_t size)
+{	struct stat	st;
+	bool		pipe_out = false;
+	bool		file_out = false;
+	size_t		i;
+
+	memset(o, 0, sizeof(*o));
+	o->Argv0 = cmdl->Argv0;
+	o->Fd = STDOUT_FILENO;
+	o->BufferSize = buffer_size;
+	o->Mode = cmdl->Output;
+	if (fstat(o->Fd, &st) == 0) {
+		pipe_out = S_ISFIFO(st.st_mode);
+		file_out = S_ISREG(st.st_mode);
+	}
+#if (defined(__linux__))
+	if (pipe_out) {
+		int	size;
+
+		/* Larger pipe, less context switches. */
+		size = fcntl(o->Fd, F_SETPIPE_SZ, PRAND_PIPE_SIZE);
+		if (size < 0) {
+			size = fcntl(o->Fd, F_GETPIPE_SZ);
+		}
+		if (size > 0) {
+			o->PipeSize = (size_t)size;
+		}
+	}
+#endif /* (defined(__linux__)) */
+	if (o->Mode == PRAND_OUTPUT_AUTO) {
+		/* vmsplice costs a mapping per buffer, asked explicitly. */
+		o->Mode = PRAND_OUTPUT_WRITE;
+	}
+	if ((o->Mode == PRAND_OUTPUT_VMSPLICE) && (o->PipeSize == 0)) {
+		fprintf(fpError, "%s: WARNING: vmsplice needs pipe to stdout, use write.\n",
+			o->Argv0
 		);
+		o->Mode = PRAND_OUTPUT_WRITE;
+	}
+	if (file_out) {
+		PrandOutputOpenFile(o, cmdl, size);
+	}
+	Stats.Backend = PrandOutputNames[o->Mode];
+
+	o->RingCount = buffers;
+	o->Ring = calloc(o->RingCount, sizeof(o->Ring[0]));
+	if ((o->RingCount > 0) && (!(o->Ring))) {
+		goto err;
+	}
+	for (i = 0; i < o->RingCount; i++) {
+		o->Ring[i] = PrandOutputAlloc(o, buffer_size);
+		if (!(o->Ring[i])) {
+			goto err;
+		}
+	}
+	return true;
+err:
+	fprintf(fpError, "%s: ERROR: Can not allocate buffer. n=%ld(0x%lx)\n",
+		o->Argv0, (long)buffer_size, (long)buffer_size
+	);
+	return false;
+}
+
+/*! Take next buffer from ring.
+ *  @return uint8_t * buffer, safe to overwrite, NULL: no memory.
+ */
+uint8_t *PrandOutputBuffer(PrandOutput *o)
+{	uint8_t	*buf;
+
+	buf = PrandOutputRenew(o, o->Ring[o->RingIndex], o->BufferSize);
+	o->Ring[o->RingIndex] = buf;
+	o->RingIndex++;
+	if (o->RingIndex >= o->RingCount) {
+		o->RingIndex = 0;
+	}
+	return buf;
+}
+
+/*! Write all bytes, retry partial write and EINTR.
+ *  @return bool true: success, false: error.
+ */
+static bool PrandOutputWriteAll(PrandOutput *o, const uint8_t *buf, size_t n)
+{	ssize_t	wlen;
+
+	if (o->Mode == PRAND_OUTPUT_STDIO) {
+		wlen = fwrite(buf, sizeof(uint8_t), n, stdout);
+		if ((size_t)wlen != n) {
+			fprintf(fpError, "%s: ERROR: Can not complete fwrite(), %s. wlen=%ld, n=%ld\n",
+				o->Argv0,
+				strerror(errno),
+				(long)(wlen), (long)(n)
+			);
+			return false;
+		}
+		return true;
+	}
+	while (n > 0) {
+		if ((o->Direct) &&
+		    ((((uintptr_t)buf) | n | o->Offset) % PRAND_BUFFER_ALIGN) != 0) {
+			/* O_DIRECT needs aligned address, length and offset. */
+			PrandOutputClearDirect(o);
+		}
+#if (defined(__linux__))
+		if (o->Mode == PRAND_OUTPUT_VMSPLICE) {
+			struct iovec	iov;
+
+			iov.iov_base = (void *)buf;
+			iov.iov_len = n;
+			wlen = vmsplice(o->Fd, &iov, 1, SPLICE_F_GIFT);
+		} else
+#endif /* (defined(__linux__)) */
+		{
+			wlen = write(o->Fd, buf, n);
+		}
+		if (wlen < 0) {
+			if (errno == EINTR) {
+				o->Interrupts++;
+				continue;
+			}
+			fprintf(fpError, "%s: ERROR: Can not complete %s(), %s. n=%ld\n",
+				o->Argv0,
+				PrandOutputNames[o->Mode],
+				strerror(errno),
+				(long)(n)
+			);
+			return false;
+		}
+		if ((size_t)wlen < n) {
+			o->ShortWrites++;
+		}
+		buf += wlen;
+		n -= wlen;
+		o->Offset += wlen;
+	}
+	return true;
+}
+
+/*! Write all bytes, counts write latency.
+ *  @return bool true: success, false: error.
+ */
+bool PrandOutputWrite(PrandOutput *o, const uint8_t *buf, size_t n)
+{	uint64_t	t0;
+	bool		result;
+
+	if (!(Stats.Enabled)) {
+		return PrandOutputWriteAll(o, buf, n);
+	}
+	t0 = PrandNow();
+	result = PrandOutputWriteAll(o, buf, n);
+	/* Count bytes written successfully. */
+	PrandStatsWrite(PrandNow() - t0, (result ? n : 0));
+	return result;
+}
+
+/*! Flush and free output.
+ *  @return bool true: success, false: error.
+ */
+bool PrandOutputClose(PrandOutput *o)
+{	bool	result = true;
+	size_t	i;
+
+	Stats.ShortWrites += o->ShortWrites;
+	Stats.Interrupts += o->Interrupts;
+	o->ShortWrites = 0;
+	o->Interrupts = 0;
+	if (fflush(stdout) != 0) {
+		fprintf(fpError, "%s: ERROR: Can not complete fflush(), %s.\n",
+			o->Argv0, strerror(errno)
+		);
+		result = false;
+	}
+	if (o->Ring) {
+		for (i = 0; i < o->RingCount; i++) {
+			PrandOutputFree(o, o->Ring[i], o->BufferSize);
+		}
+		free(o->Ring);
+		o->Ring = NULL;
+	}
+	return result;
+}
+
+bool EmitPesudoRand(CCommandLine *cmdl)
+{	PrandOutput	out;
+	uint8_t		*buf;
+	ssize_t		remain;
+	ssize_t		n;
+	bool		result = true;
+	PrandGen	gen;
+
+	/* Fixed size buffers, streams any length in constant memory. */
+	if (!PrandOutputOpen(&out, cmdl, PRAND_BUFFER_SIZE, 1, cmdl->Length)) {
+		PrandOutputClose(&out);
+		return false;
+	}
+	if (!PrandGenInit(&gen, cmdl, cmdl->Offset)) {
+		PrandOutputClose(&out);
+		return false;
+	}
+
+	remain = cmdl->Length;
+	while (remain > 0) {
+		n = remain;
+		if (n > PRAND_BUFFER_SIZE) {
+			n = PRAND_BUFFER_SIZE;
+		}
+		buf = PrandOutputBuffer(&out);
+		if (!buf) {
+			result = false;
+			break;
+		}
+		PrandGenFill(&gen, buf, n);
+		if (!PrandOutputWrite(&out, buf, n)) {
+			result = false;
+			break;
+		}
+		remain -= n;
+	}
+	PrandGenFree(&gen);
+	if (!PrandOutputClose(&out)) {
+		result = false;
+	}
+	return result;
+}
+
+/*! Base64 alphabet, '_' replaces '/' to make file name safe. */
+static const char Base64Chars[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+_";
+
+/*! Encode bytes into base64 characters, scalar.
+ *  @param dst points characters, n / 3 * 4 bytes.
+ *  @param src points bytes.
+ *  @param n the number of bytes, multiple of 3.
+ */
+static void Base64EncodeScalar(char *dst, const uint8_t *src, size_t n)
+{	uint32_t	w;
+
+	while (n >= 3) {
+		w = ((uint32_t)src[0] << 16) | ((uint32_t)src[1] << 8) | src[2];
+		dst[0] = Base64Chars[(w >> 18) & 0x3f];
+		dst[1] = Base64Chars[(w >> 12) & 0x3f];
+		dst[2] = Base64Chars[(w >> 6) & 0x3f];
+		dst[3] = Base64Chars[w & 0x3f];
+		src += 3;
+		dst += 4;
+		n -= 3;
+	}
+}
+
+#if (defined(PRAND_B64_X86))
+/*! Encode bytes into base64 characters, AVX2.
+ *  24 bytes to 32 characters per step. Spread 3 bytes into 4 lanes
+ *  of 6 bits by shuffle and multiplies, then map 6 bits values to
+ *  characters by adding an offset looked up by range.
+ *  See W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding
+ *  Using AVX2 Instructions".
+ */
+__attribute__((target("avx2")))
+static void Base64EncodeAvx2(char *dst, const uint8_t *src, size_t n)
+{	const __m256i	shuf = _mm256_setr_epi8(
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+	);
+	const __m256i	offsets = _mm256_setr_epi8(
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+		'_' - 63, 'A', 0, 0,
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+		'_' - 63, 'A', 0, 0
+	);
+	__m256i	in, t0, t1, t2, t3, idx, r;
+
+	/* Each 128 bit load reads 16 bytes, uses 12 bytes. */
+	while (n >= 28) {
+		in = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)src)),
+			_mm_loadu_si128((const __m128i *)(src + 12)), 1
+		);
+		in = _mm256_shuffle_epi8(in, shuf);
+		t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+		t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+		t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+		t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+		idx = _mm256_or_si256(t1, t3);
+
+		/* 0..25: 13, 26..51: 0, 52..61: 1..10, 62: 11, 63: 12 */
+		r = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+		r = _mm256_or_si256(r, _mm256_and_si256(
+			_mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx),
+			_mm256_set1_epi8(13))
+		);
+		r = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, r), idx);
+		_mm256_storeu_si256((__m256i *)dst, r);
+		src += 24;
+		dst += 32;
+		n -= 24;
+	}
+	Base64EncodeScalar(dst, src, n);
+}
+#endif /* (defined(PRAND_B64_X86)) */
+
+/*! Encode bytes into base64 characters, fastest variant on this CPU.
+ *  @param dst points characters, n / 3 * 4 bytes.
+ *  @param src points bytes.
+ *  @param n the number of bytes, multiple of 3.
+ */
+void Base64Encode(char *dst, const uint8_t *src, size_t n)
+{
+#if (defined(PRAND_B64_X86))
+	if (__builtin_cpu_supports("avx2")) {
+		Base64EncodeAvx2(dst, src, n);
+		return;
+	}
+#endif /* (defined(PRAND_B64_X86)) */
+	Base64EncodeScalar(dst, src, n);
+}
+
+/*! Bytes encoded at once, encoded characters fill an output buffer. */
+#define	PRAND_B64_BYTES		(PRAND_BUFFER_SIZE / 4 * 3)
+
+/*! Emit Length characters of base64 text and newline.
+ *  Encodes ((Length + 3) / 4) * 3 bytes of the stream.
+ *  @return bool true: success, false: error.
+ */
+bool EmitBase64Rand(CCommandLine *cmdl)
+{	PrandOutput	out;
+	PrandGen	gen;
+	uint8_t		*bin = NULL;
+	uint8_t		*buf;
+	ssize_t		remain;
+	size_t		n;
+	size_t		chars;
+	uint64_t	t0;
+	bool		result = true;
+
+	if (cmdl->Length == 0) {
+		return true;
+	}
+	if (!PrandOutputOpen(&out, cmdl, PRAND_BUFFER_SIZE, 1, cmdl->Length + 1)) {
+		PrandOutputClose(&out);
+		return false;
+	}
+	if (!PrandGenInit(&gen, cmdl, cmdl->Offset)) {
+		PrandOutputClose(&out);
+		return false;
+	}
+	bin = PrandBufferGet(PRAND_B64_BYTES);
+	if (!bin) {
+		fprintf(fpError, "%s: ERROR: Can not allocate buffer. n=%ld(0x%lx)\n",
+			cmdl->Argv0, (long)PRAND_B64_BYTES, (long)PRAND_B64_BYTES
+		);
+		result = false;
+		goto out;
+	}
+
+	remain = cmdl->Length;
+	while (remain > 0) {
+		chars = remain;
+		if (chars > PRAND_BUFFER_SIZE) {
+			chars = PRAND_BUFFER_SIZE;
+		}
+		n = (chars + 3) / 4 * 3;
+		PrandGenFill(&gen, bin, n);
+		buf = PrandOutputBuffer(&out);
+		if (!buf) {
+			result = false;
+			goto out;
+		}
+		if (!(Stats.Enabled)) {
+			Base64Encode((char *)buf, bin, n);
+		} else {
+			t0 = PrandNow();
+			Base64Encode((char *)buf, bin, n);
+			Stats.EncodeNs += PrandNow() - t0;
+		}
+		if (!PrandOutputWrite(&out, buf, chars)) {
+			result = false;
+			goto out;
+		}
+		remain -= chars;
+	}
+	if (!PrandOutputWrite(&out, (const uint8_t *)"\n", 1)) {
+		result = false;
+	}
+out:
+	PrandBufferPut(bin, PRAND_B64_BYTES);
+	PrandGenFree(&gen);
+	if (!PrandOutputClose(&out)) {
+		result = false;
+	}
+	return result;
+}
+
+/*! Values converted at once. */
+#define	PRAND_NUMBER_CHUNK	(4096)
+/*! Longest formatted value, "18446744073709551615\n". */
+#define	PRAND_NUMBER_CHARS_MAX	(21)
+
+/*! Two digits table, "00" to "99". */
+static const char DecimalPairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/*! Format value in decimal and newline.
+ *  @param dst points buffer, PRAND_NUMBER_CHARS_MAX bytes at least.
+ *  @return size_t the number of characters written.
+ */
+static size_t FormatDecimal(char *dst, uint64_t v)
+{	char	tmp[PRAND_NUMBER_CHARS_MAX];
+	char	*p = tmp + sizeof(tmp);
+	size_t	n;
+	unsigned	d;
+
+	*(--p) = '\n';
+	while (v >= 100) {
+		d = (unsigned)(v % 100);
+		v /= 100;
+		p -= 2;
+		memcpy(p, &(DecimalPairs[d * 2]), 2);
+	}
+	if (v >= 10) {
+		p -= 2;
+		memcpy(p, &(DecimalPairs[v * 2]), 2);
+	} else {
+		*(--p) = (char)('0' + v);
+	}
+	n = tmp + sizeof(tmp) - p;
+	memcpy(dst, p, n);
+	return n;
+}
+
+/*! Format value in 0x%016x form and newline.
+ *  @param dst points buffer, 19 bytes at least.
+ *  @return size_t the number of characters written.
+ */
+static size_t FormatHex(char *dst, uint64_t v)
+{	static const char	hex[] = "0123456789abcdef";
+	int	i;
+
+	dst[0] = '0';
+	dst[1] = 'x';
+	for (i = 17; i >= 2; i--) {
+		dst[i] = hex[v & 0xf];
+		v >>= 4;
+	}
+	dst[18] = '\n';
+	return 19;
+}
+
+/*! Emit Length 64 bit unsigned integers, one per line.
+ *  A value is made from 8 bytes of the stream in little endian order,
+ *  the same as "od -t x8" on little endian host. With -r, a value is
+ *  mapped into [min, max] by min + floor(range * value / 2^64).
+ *  @return bool true: success, false: error.
+ */
+bool EmitNumberRand(CCommandLine *cmdl)
+{	PrandOutput	out;
+	PrandGen	gen;
+	uint8_t		bin[PRAND_NUMBER_CHUNK * 8];
+	uint8_t		*buf;
+	size_t		pos;
+	ssize_t		remain;
+	size_t		m;
+	size_t		i;
+	size_t		j;
+	uint64_t	v;
+	uint64_t	lo;
+	uint64_t	size;
+	uint64_t	t0 = 0;
+	uint64_t	w0 = 0;
+	bool		result = true;
+
+	/* Hex values have fixed width, decimal ones don't. */
+	size = 0;
+	if (cmdl->Format == PRAND_FORMAT_HEX) {
+		size = (uint64_t)(cmdl->Length) * 19;
+	}
+	if (!PrandOutputOpen(&out, cmdl, PRAND_BUFFER_SIZE, 1, size)) {
+		PrandOutputClose(&out);
+		return false;
+	}
+	if (!PrandGenInit(&gen, cmdl, cmdl->Offset)) {
+		PrandOutputClose(&out);
+		return false;
+	}
+
+	buf = PrandOutputBuffer(&out);
+	if (!buf) {
+		result = false;
+		goto out;
+	}
+	pos = 0;
+	remain = cmdl->Length;
+	while (remain > 0) {
+		m = remain;
+		if (m > PRAND_NUMBER_CHUNK) {
+			m = PRAND_NUMBER_CHUNK;
+		}
+		PrandGenFill(&gen, bin, m * 8);
+		/* Encode time is loop time except writes in it. */
+		if (Stats.Enabled) {
+			t0 = PrandNow();
+			w0 = Stats.WriteNs;
+		}
+		for (i = 0; i < m; i++) {
+			v = 0;
+			for (j = 0; j < 8; j++) {
+				v |= (uint64_t)(bin[i * 8 + j]) << (j * 8);
+			}
+			if ((cmdl->Mapped) && (cmdl->MappedRange != 0)) {
+				v = cmdl->MappedMin + PrngEngineMulHi64(v, cmdl->MappedRange, &lo);
+			}
+			if (pos + PRAND_NUMBER_CHARS_MAX > PRAND_BUFFER_SIZE) {
+				if (!PrandOutputWrite(&out, buf, pos)) {
+					result = false;
+					goto out;
+				}
+				buf = PrandOutputBuffer(&out);
+				if (!buf) {
+					result = false;
+					goto out;
+				}
+				pos = 0;
+			}
+			if (cmdl->Format == PRAND_FORMAT_HEX) {
+				pos += FormatHex((char *)(buf + pos), v);
+			} else {
+				pos += FormatDecimal((char *)(buf + pos), v);
+			}
+		}
+		if (Stats.Enabled) {
+			Stats.EncodeNs += (PrandNow() - t0) - (Stats.WriteNs - w0);
+		}
+		remain -= m;
+	}
+	if (!PrandOutputWrite(&out, buf, pos)) {
+		result = false;
+	}
+out:
+	PrandGenFree(&gen);
+	if (!PrandOutputClose(&out)) {
+		result = false;
+	}
+	return result;
+}
+
+/*! The maximum chunk size generated by a thread at once.
+ *  @note A worker jumps over other threads' chunks after each chunk.
+ *        Jump of mt19937ar or mt64 costs about the same time as
+ *        generating 8 MiB packed (2 MiB legacy) bytes by mt19937ar,
+ *        32 MiB keeps it under a quarter of generation time.
+ */
+#define	PRAND_CHUNK_SIZE	(32 * 1024 * 1024)
+
+/*! The minimum chunk size, small output is split among threads down to this. */
+#define	PRAND_CHUNK_MIN		(8 * 1024 * 1024)
+
+/*! Chunk size is multiple of this, draw bytes and direct I/O alignment. */
+#define	PRAND_CHUNK_ALIGN	(1024 * 1024)
+
+/*! Output slot, holds a chunk from a worker to the writer. */
+typedef struct {
+	uint8_t		*Buf;
+	ssize_t		Length;
+	bool		Ready;		/*!< Chunk is generated, to be written. */
+} PrandSlot;
+
+/*! Threaded generation, shared between workers and the writer. */
+typedef struct {
+	CCommandLine	*Cmdl;
+	pthread_mutex_t	Lock;
+	pthread_cond_t	CondReady;	/*!< Signaled when a slot gets ready. */
+	pthread_cond_t	CondFree;	/*!< Signaled when a slot is written. */
+	PrandSlot	*Slots;
+	long		SlotCount;
+	ssize_t		ChunkSize;	/*!< Bytes per chunk, except the last one. */
+	uint64_t	Chunks;		/*!< The number of chunks to output. */
+	uint64_t	Written;	/*!< The number of chunks written. */
+	bool		Abort;		/*!< Stop workers. */
+	void		*Jump;		/*!< Jump over other threads' chunks. */
+} PrandShared;
+
+/*! Worker thread instance. */
+typedef struct {
+	PrandShared	*Shared;
+	long		Index;
+	pthread_t	Thread;
+	PrandGen	Gen;
+} PrandWorker;
+
+/*! Generate chunks Index, Index + Threads, ... into slots.
+ *  @param arg points PrandWorker.
+ */
+void *PrandWorkerMain(void *arg)
+{	PrandWorker	*w = arg;
+	PrandShared	*sh = w->Shared;
+	long		threads = sh->Cmdl->Threads;
+	uint64_t	c;
+	PrandSlot	*slot;
+	ssize_t		n;
+	bool		abort;
+
+	for (c = (uint64_t)(w->Index); c < sh->Chunks; c += threads) {
+		slot = &(sh->Slots[c % sh->SlotCount]);
+		pthread_mutex_lock(&(sh->Lock));
+		/* Wait the writer to free the slot, it held chunk c - SlotCount. */
+		while ((!(sh->Abort)) && (c >= sh->Written + sh->SlotCount)) {
+			pthread_cond_wait(&(sh->CondFree), &(sh->Lock));
+		}
+		abort = sh->Abort;
+		pthread_mutex_unlock(&(sh->Lock));
+		if (abort) {
+			break;
+		}
+
+		n = sh->ChunkSize;
+		if (c == sh->Chunks - 1) {
+			n = sh->Cmdl->Length - (ssize_t)c * sh->ChunkSize;
+		}
+		PrandGenFill(&(w->Gen), slot->Buf, n);
+
+		pthread_mutex_lock(&(sh->Lock));
+		slot->Length = n;
+		slot->Ready = true;
+		pthread_cond_broadcast(&(sh->CondReady));
+		pthread_mutex_unlock(&(sh->Lock));
+
+		if (c + threads < sh->Chunks) {
+			PrandGenJump(&(w->Gen), sh->Jump);
+		}
+	}
+	return NULL;
+}
+
+/*! Generate by threads, write chunks in order.
+ *  @param cmdl points command line.
+ *  @return bool true: success, false: error.
+ */
+bool EmitPesudoRandThreads(CCommandLine *cmdl)
+{	PrandShared	sh;
+	PrandWorker	*workers = NULL;
+	long		threads = cmdl->Threads;
+	long		started = 0;
+	long		i;
+	uint64_t	c;
+	PrandSlot	*slot;
+	PrandOutput	out;
+	uint64_t	t0 = 0;
+	int		rc;
+	bool		result = true;
+
+	memset(&sh, 0, sizeof(sh));
+	sh.Cmdl = cmdl;
+	/* Split output among threads, in chunk size range. */
+	sh.ChunkSize = (cmdl->Length / threads + PRAND_CHUNK_ALIGN - 1) & ~((ssize_t)PRAND_CHUNK_ALIGN - 1);
+	if (sh.ChunkSize < PRAND_CHUNK_MIN) {
+		sh.ChunkSize = PRAND_CHUNK_MIN;
+	}
+	if (sh.ChunkSize > PRAND_CHUNK_SIZE) {
+		sh.ChunkSize = PRAND_CHUNK_SIZE;
+	}
+	sh.Chunks = ((uint64_t)(cmdl->Length) + sh.ChunkSize - 1) / sh.ChunkSize;
+	if (sh.Chunks == 0) {
+		return true;
+	}
+	/* Slot buffers are written directly, output owns no buffer. */
+	if (!PrandOutputOpen(&out, cmdl, sh.ChunkSize, 0, cmdl->Length)) {
+		PrandOutputClose(&out);
+		return false;
+	}
+	if ((uint64_t)threads > sh.Chunks) {
+		threads = (long)(sh.Chunks);
+		cmdl->Threads = threads;
+	}
+	/* A slot per thread and two more, workers run ahead while the
+	 * writer writes. Chunks are large, keep memory bounded.
+	 */
+	sh.SlotCount = threads + 2;
+	pthread_mutex_init(&(sh.Lock), NULL);
+	pthread_cond_init(&(sh.CondReady), NULL);
+	pthread_cond_init(&(sh.CondFree), NULL);
+
+	sh.Slots = calloc(sh.SlotCount, sizeof(sh.Slots[0]));
+	workers = calloc(threads, sizeof(workers[0]));
+	if ((!(sh.Slots)) || (!workers)) {
+		fprintf(fpError, "%s: ERROR: Can not allocate thread context.\n",
+			cmdl->Argv0
+		);
+		result = false;
+		goto out;
+	}
+	for (i = 0; i < sh.SlotCount; i++) {
+		sh.Slots[i].Buf = PrandOutputAlloc(&out, sh.ChunkSize);
+		if (!(sh.Slots[i].Buf)) {
+			fprintf(fpError, "%s: ERROR: Can not allocate buffer. n=%ld(0x%lx)\n",
+				cmdl->Argv0, (long)(sh.ChunkSize), (long)(sh.ChunkSize)
+			);
+			result = false;
+			goto out;
+		}
+	}
+
+	for (i = 0; i < threads; i++) {
+		PrandWorker	*w = &(workers[i]);
+
+		w->Shared = &sh;
+		w->Index = i;
+		/* Start at the first chunk of this worker. */
+		if (!PrandGenInit(&(w->Gen), cmdl,
+			cmdl->Offset + (uint64_t)i * sh.ChunkSize)) {
+			result = false;
+			goto out;
+		}
+	}
+	/* Chunk size is multiple of draw bytes, all workers jump the same draws. */
+	sh.Jump = PrngEngineJumpNew(cmdl->Engine,
+		PrandGenJumpDraws(&(workers[0].Gen), (uint64_t)(threads - 1) * sh.ChunkSize)
+	);
+	if (!(sh.Jump)) {
+		fprintf(fpError, "%s: ERROR: Can not allocate thread context.\n",
+			cmdl->Argv0
+		);
+		result = false;
+		goto out;
+	}
+	for (i = 0; i < threads; i++) {
+		rc = pthread_create(&(workers[i].Thread), NULL, PrandWorkerMain, &(workers[i]));
+		if (rc != 0) {
+			fprintf(fpError, "%s: ERROR: Can not create thread, %s.\n",
+				cmdl->Argv0, strerror(rc)
+			);
+			result = false;
+			goto out;
+		}
+		started++;
+	}
+
+	for (c = 0; c < sh.Chunks; c++) {
+		slot = &(sh.Slots[c % sh.SlotCount]);
+		if (Stats.Enabled) {
+			t0 = PrandNow();
+		}
+		pthread_mutex_lock(&(sh.Lock));
+		while (!(slot->Ready)) {
+			pthread_cond_wait(&(sh.CondReady), &(sh.Lock));
+		}
+		pthread_mutex_unlock(&(sh.Lock));
+		if (Stats.Enabled) {
+			Stats.WaitNs += PrandNow() - t0;
+		}
+
+		if (!PrandOutputWrite(&out, slot->Buf, slot->Length)) {
+			result = false;
+			goto out;
+		}
+		/* Gifted chunk is never refilled, take fresh one. */
+		slot->Buf = PrandOutputRenew(&out, slot->Buf, sh.ChunkSize);
+		if (!(slot->Buf)) {
+			result = false;
+			goto out;
+		}
+
+		pthread_mutex_lock(&(sh.Lock));
+		slot->Ready = false;
+		sh.Written++;
+		pthread_cond_broadcast(&(sh.CondFree));
+		pthread_mutex_unlock(&(sh.Lock));
+	}
+out:
+	pthread_mutex_lock(&(sh.Lock));
+	sh.Abort = true;
+	pthread_cond_broadcast(&(sh.CondFree));
+	pthread_mutex_unlock(&(sh.Lock));
+	for (i = 0; i < started; i++) {
+		pthread_join(workers[i].Thread, NULL);
+	}
+	if (workers) {
+		for (i = 0; i < threads; i++) {
+			PrandGenFree(&(workers[i].Gen));
+		}
+		free(workers);
+	}
+	if (sh.Slots) {
+		for (i = 0; i < sh.SlotCount; i++) {
+			PrandOutputFree(&out, sh.Slots[i].Buf, sh.ChunkSize);
+		}
+		free(sh.Slots);
+	}
+	if (sh.Jump) {
+		PrngEngineJumpFree(cmdl->Engine, sh.Jump);
+	}
+	pthread_cond_destroy(&(sh.CondFree));
+	pthread_cond_destroy(&(sh.CondReady));
+	pthread_mutex_destroy(&(sh.Lock));
+	if (!PrandOutputClose(&out)) {
+		result = false;
+	}
+	return result;
+}
+
+/*! Values drawn at once in bounded integer mode. */
+#define	BOUNDED_CHUNK	(256)
+
+bool EmitBoundedRand(CCommandLine *cmdl)
+{	uint64_t	buf[BOUNDED_CHUNK];
+	ssize_t		n;
+	ssize_t		m;
+	ssize_t		i;
+	int		len;
+	uint64_t	t0 = 0;
+	uint64_t	t1 = 0;
+	bool		result = true;
+	PrngEngine	pe;
+
+	if (!PrngEngineInit(&pe, cmdl->Engine)) {
+		fprintf(fpError, "%s: ERROR: Can not allocate engine context. engine=%s\n",
+			cmdl->Argv0, cmdl->Engine->Name
+		);
+		return false;
+	}
+	PrngEngineSeed(&pe, (uint64_t)(cmdl->Seed));
+	PrngEngineDiscard(&pe, cmdl->Offset);
+
+	n = cmdl->Length;
+	while (n > 0) {
+		m = n;
+		if (m > BOUNDED_CHUNK) {
+			m = BOUNDED_CHUNK;
+		}
+		if (Stats.Enabled) {
+			t0 = PrandNow();
+		}
+		PrngEngineFillBounded64(&pe, buf, m, cmdl->BoundedRange);
+		if (Stats.Enabled) {
+			t1 = PrandNow();
+			Stats.GenNs += t1 - t0;
+		}
+		/* printf() formats and writes, counted as encode. */
+		for (i = 0; i < m; i++) {
+			len = printf("%" PRIu64 "\n", cmdl->BoundedMin + buf[i]);
+			if (len < 0) {
+				fprintf(fpError, "%s: ERROR: Can not complete printf(), %s.\n",
+					cmdl->Argv0,
+					strerror(errno)
+				);
+				result = false;
+				goto out;
+			}
+			if (Stats.Enabled) {
+				Stats.Bytes += len;
+			}
+		}
+		if (Stats.Enabled) {
+			Stats.EncodeNs += PrandNow() - t1;
+		}
+		n -= m;
+	}
+out:
+	/* printf() buffers, write error shows at flush or in error flag. */
+	if ((fflush(stdout) != 0) || (ferror(stdout))) {
+		fprintf(fpError, "%s: ERROR: Can not complete fflush(), %s.\n",
+			cmdl->Argv0, strerror(errno)
+		);
+		clearerr(stdout);
+		result = false;
+	}
+	PrngEngineFree(&pe);
+	return result;
+}
+
+/* Print help message. */
+void PrandHelp(const char *a0)
+{
+	fprintf(fpError, HelpMessage,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0,
+		a0
+	);
+	PrngEngineHelp(fpError, a0);
+}
+
+/*! Emit output specified by command line.
+ *  @return bool true: success, false: error.
+ */
+static bool PrandEmitOne(CCommandLine *cmdl)
+{	bool	result;
+
+	if (cmdl->OutputPath) {
+		if (!PrandOutputRedirect(cmdl)) {
+			return false;
+		}
+	}
+	if (cmdl->Bounded) {
+		result = EmitBoundedRand(cmdl);
+	} else if (cmdl->Format == PRAND_FORMAT_B64) {
+		result = EmitBase64Rand(cmdl);
+	} else if ((cmdl->Format == PRAND_FORMAT_DEC) ||
+		   (cmdl->Format == PRAND_FORMAT_HEX)) {
+		result = EmitNumberRand(cmdl);
+	} else if (cmdl->Threads > 1) {
+		result = EmitPesudoRandThreads(cmdl);
+	} else {
+		result = EmitPesudoRand(cmdl);
+	}
+	return result;
+}
+
+/*! Emit output specified by command line, with statistics.
+ *  @return bool true: success, false: error.
+ */
+bool PrandEmit(CCommandLine *cmdl)
+{	bool	result;
+
+	PrandStatsBegin(cmdl);
+	result = PrandEmitOne(cmdl);
+	PrandStatsEnd(cmdl);
+	return result;
+}
+
+/*! Create files listed in manifest, "seed bytes_to_output path" per line.
+ *  Buffers are reused from file to file, see PrandBufferGet().
+ *  @return bool true: success, false: error.
+ */
+bool PrandManifest(CCommandLine *cmdl)
+{	FILE		*fp;
+	char		*line = NULL;
+	size_t		line_size = 0;
+	ssize_t		len;
+	unsigned long	line_num = 0;
+	unsigned long	seed;
+	long		size;
+	char		*p;
+	char		*p2;
+	int		fd_stdout;
+	CCommandLine	req;
+	bool		result = true;
+
+	if (strcmp(cmdl->Manifest, "-") == 0) {
+		fp = stdin;
+	} else {
+		fp = fopen(cmdl->Manifest, "r");
+		if (!fp) {
+			fprintf(fpError, "%s: ERROR: Can not open manifest, %s. path=\"%s\"\n",
+				cmdl->Argv0, strerror(errno), cmdl->Manifest
+			);
+			return false;
+		}
+	}
+	fd_stdout = dup(STDOUT_FILENO);
+	if (fd_stdout == INVALID_FD) {
+		fprintf(fpError, "%s: ERROR: Can not duplicate stdout, %s.\n",
+			cmdl->Argv0, strerror(errno)
+		);
+		result = false;
+		goto out;
+	}
+
+	PrandStatsBegin(cmdl);
+	while ((len = getline(&line, &line_size, fp)) >= 0) {
+		line_num++;
+		while ((len > 0) && ((line[len - 1] == '\n') || (line[len - 1] == '\r'))) {
+			len--;
+			line[len] = 0;
+		}
+		p = line;
+		while ((*p == ' ') || (*p == '\t')) {
+			p++;
+		}
+		if ((*p == 0) || (*p == '#')) {
+			continue;
+		}
+		errno = 0;
+		seed = strtoul(p, &p2, 0);
+		if ((p2 == p) || (errno != 0) || ((*p2 != ' ') && (*p2 != '\t'))) {
+			goto err_syntax;
+		}
+		p = p2;
+		size = strtol(p, &p2, 0);
+		if ((p2 == p) || (errno != 0) || (size < 0) || ((*p2 != ' ') && (*p2 != '\t'))) {
+			goto err_syntax;
+		}
+		p = p2;
+		while ((*p == ' ') || (*p == '\t')) {
+			p++;
+		}
+		if (*p == 0) {
+			goto err_syntax;
+		}
+
+		req = *cmdl;
+		req.Seed = seed;
+		req.Length = size;
+		req.OutputPath = p;
+		if (!PrandEmitOne(&req)) {
+			fprintf(fpError, "%s: ERROR: Can not create file. line=%lu, path=\"%s\"\n",
+				cmdl->Argv0, line_num, p
+			);
+			result = false;
+			break;
+		}
+		continue;
+err_syntax:
+		fprintf(fpError, "%s: ERROR: Specify \"seed bytes_to_output path\" in manifest. line=%lu\n",
+			cmdl->Argv0, line_num
+		);
+		result = false;
+		break;
+	}
+	PrandStatsEnd(cmdl);
+	fflush(stdout);
+	dup2(fd_stdout, STDOUT_FILENO);
+	close(fd_stdout);
+out:
+	free(line);
+	if (fp != stdin) {
+		fclose(fp);
+	}
+	return result;
+}
+
+/*! Longest request in bytes. */
+#define	PRAND_REQUEST_SIZE	(4096)
+/*! Most arguments in a request. */
+#define	PRAND_REQUEST_ARGS	(64)
+/*! Largest frame of output in reply. */
+#define	PRAND_FRAME_SIZE	(PRAND_BUFFER_SIZE)
+/*! Seconds to wait client to send request or to receive output. */
+#define	PRAND_SERVER_TIMEOUT	(10)
+
+/*! Server statistics. */
+typedef struct {
+	uint64_t	Requests;
+	uint64_t	Errors;
+	double		LatencyMin;	/*!< In seconds. */
+	double		LatencyMax;
+	double		LatencySum;
+} PrandServerStats;
+
+/*! Set by SIGINT or SIGTERM. */
+static volatile sig_atomic_t	PrandServerStop = 0;
+
+static void PrandServerSignal(__maybe_unused int sig)
+{	PrandServerStop = 1;
+}
+
+/*! Write all bytes to fd, retry partial write and EINTR.
+ *  @return bool true: success, false: error.
+ */
+static bool PrandWriteAll(int fd, const void *buf, size_t n)
+{	const uint8_t	*p = buf;
+	ssize_t		wlen;
+
+	while (n > 0) {
+		wlen = write(fd, p, n);
+		if (wlen < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		p += wlen;
+		n -= wlen;
+	}
+	return true;
+}
+
+/*! Read request, arguments each followed by LF, ends with empty line.
+ *  @param buf points buffer, PRAND_REQUEST_SIZE bytes.
+ *  @param argv points argument array, PRAND_REQUEST_ARGS + 2 elements,
+ *         argv[0] is set by caller.
+ *  @return int argc, -1: error.
+ */
+static int PrandServerRead(int conn, char *buf, char **argv)
+{	size_t	len = 0;
+	ssize_t	rlen;
+	char	*p;
+	char	*lf;
+	int	argc = 1;
+
+	while (true) {
+		if (len >= PRAND_REQUEST_SIZE - 1) {
+			return -1;
+		}
+		rlen = read(conn, buf + len, PRAND_REQUEST_SIZE - 1 - len);
+		if (rlen < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		if (rlen == 0) {
+			return -1;
+		}
+		len += rlen;
+		buf[len] = 0;
+		if ((len == 1) && (buf[0] == '\n')) {
+			break;
+		}
+		if ((len >= 2) && (strstr(buf, "\n\n") != NULL)) {
+			break;
+		}
+	}
+	p = buf;
+	while (*p != '\n') {
+		lf = strchr(p, '\n');
+		if (argc > PRAND_REQUEST_ARGS) {
+			return -1;
+		}
+		*lf = 0;
+		argv[argc] = p;
+		argc++;
+		p = lf + 1;
+	}
+	argv[argc] = NULL;
+	return argc;
+}
+
+/*! Relay output from pipe to connection. */
+typedef struct {
+	int	Pipe;		/*!< Read end of output pipe, relay closes it. */
+	int	Conn;
+	bool	Result;
+} PrandRelay;
+
+/*! Relay output in frames, length in hex and LF, then bytes.
+ *  Closes pipe at end, emitter to broken connection gets EPIPE.
+ *  @param arg points PrandRelay.
+ */
+static void *PrandServerRelay(void *arg)
+{	PrandRelay	*r = arg;
+	uint8_t		*buf;
+	char		head[24];
+	ssize_t		rlen;
+	int		hlen;
+
+	r->Result = false;
+	buf = malloc(PRAND_FRAME_SIZE);
+	while (buf) {
+		rlen = read(r->Pipe, buf, PRAND_FRAME_SIZE);
+		if (rlen < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		if (rlen == 0) {
+			r->Result = true;
+			break;
+		}
+		hlen = snprintf(head, sizeof(head), "%lx\n", (unsigned long)rlen);
+		if ((!PrandWriteAll(r->Conn, head, hlen)) ||
+		    (!PrandWriteAll(r->Conn, buf, rlen))) {
+			break;
+		}
+	}
+	free(buf);
+	close(r->Pipe);
+	return NULL;
+}
+
+/*! Emit request output through relay to connection.
+ *  @return bool true: success, false: error.
+ */
+static bool PrandServerEmit(CCommandLine *req, int conn, int fd_stdout)
+{	PrandRelay	relay;
+	pthread_t	thread;
+	int		pfd[2];
+	int		rc;
+	bool		result = true;
+
+	if (pipe(pfd) != 0) {
+		fprintf(fpError, "%s: ERROR: Can not create pipe, %s.\n",
+			req->Argv0, strerror(errno)
+		);
+		return false;
+	}
+	relay.Pipe = pfd[0];
+	relay.Conn = conn;
+	relay.Result = false;
+	rc = pthread_create(&thread, NULL, PrandServerRelay, &relay);
+	if (rc != 0) {
+		fprintf(fpError, "%s: ERROR: Can not create thread, %s.\n",
+			req->Argv0, strerror(rc)
+		);
+		close(pfd[0]);
+		close(pfd[1]);
+		return false;
+	}
+	fflush(stdout);
+	if (dup2(pfd[1], STDOUT_FILENO) < 0) {
+		fprintf(fpError, "%s: ERROR: Can not redirect output, %s.\n",
+			req->Argv0, strerror(errno)
+		);
+		result = false;
+	}
+	close(pfd[1]);
+	if ((result) && (!PrandEmit(req))) {
+		result = false;
+	}
+	fflush(stdout);
+	clearerr(stdout);
+	/* Closes last write end of pipe, relay reads end of output. */
+	dup2(fd_stdout, STDOUT_FILENO);
+	pthread_join(thread, NULL);
+	if (!(relay.Result)) {
+		fprintf(fpError, "%s: ERROR: Can not send output.\n", req->Argv0);
+		result = false;
+	}
+	return result;
+}
+
+/*! Serve a request on connection.
+ *  Output is sent in frames, ends with empty frame and status line.
+ *  Error messages are collected and sent back after status line.
+ *  @return bool true: success, false: error.
+ */
+static bool PrandServerRequest(CCommandLine *srv, int conn, int fd_stdout)
+{	char		buf[PRAND_REQUEST_SIZE];
+	char		*argv[PRAND_REQUEST_ARGS + 2];
+	int		argc;
+	CCommandLine	req;
+	FILE		*fp_error_saved = fpError;
+	FILE		*fp_msg;
+	char		*msg = NULL;
+	size_t		msg_len = 0;
+	bool		parsed;
+	bool		switched;
+	bool		result = true;
+
+	argv[0] = (char *)(srv->Argv0);
+	argc = PrandServerRead(conn, buf, argv);
+	if (argc < 0) {
+		fprintf(fpError, "%s: ERROR: Broken request.\n", srv->Argv0);
+		return false;
+	}
+
+	/* Parse request, collect messages to send back. */
+	fp_msg = open_memstream(&msg, &msg_len);
+	if (!fp_msg) {
+		fprintf(fpError, "%s: ERROR: Can not allocate message buffer.\n", srv->Argv0);
+		return false;
+	}
+	fpError = fp_msg;
+	req = CCommandLineDefault;
+	GetOptAltClear(&GetOptAltState);
+	optind = 1;
+	parsed = CCommandLineParse(&req, argc, argv);
+	switched = (fpError != fp_msg);
+	/* -V e switches error output to stdout, server's output. */
+	fpError = fp_msg;
+	if ((!parsed) || (req.Help)) {
+		PrandHelp(srv->Argv0);
+		parsed = false;
+	}
+	if ((parsed) && (switched)) {
+		fprintf(fpError, "%s: ERROR: Can not set debug switch in request.\n", srv->Argv0);
+		parsed = false;
+	}
+	if ((parsed) && (req.ServePath)) {
+		fprintf(fpError, "%s: ERROR: Can not serve in request.\n", srv->Argv0);
+		parsed = false;
+	}
+	if ((parsed) && (req.Manifest)) {
+		fprintf(fpError, "%s: ERROR: Can not use manifest in request.\n", srv->Argv0);
+		parsed = false;
+	}
+	if ((parsed) && (req.OutputPath) && (req.OutputPath[0] != '/')) {
+		/* Server's working directory is not client's. */
+		fprintf(fpError, "%s: ERROR: Output path should be absolute in request. path=\"%s\"\n",
+			srv->Argv0, req.OutputPath
+		);
+		parsed = false;
+	}
+	if (parsed) {
+		if (PrandWriteAll(conn, "OK\n", 3)) {
+			result = PrandServerEmit(&req, conn, fd_stdout);
+			/* Empty frame, status line of output follows. */
+			PrandWriteAll(conn, "0\n", 2);
+		} else {
+			result = false;
+		}
+	} else {
+		result = false;
+	}
+	fpError = fp_error_saved;
+	fclose(fp_msg);
+	if (result) {
+		PrandWriteAll(conn, "OK\n", 3);
+	} else {
+		PrandWriteAll(conn, "ERROR\n", 6);
+	}
+	PrandWriteAll(conn, msg, msg_len);
+	free(msg);
+	return result;
+}
+
+/*! Serve requests until SIGINT or SIGTERM.
+ *  @return bool true: success, false: error.
+ */
+bool PrandServe(CCommandLine *cmdl)
+{	struct sockaddr_un	addr;
+	struct sigaction	sa;
+	struct stat		st;
+	struct timespec		t0;
+	struct timespec		t1;
+	PrandServerStats	stats;
+	double			latency;
+	int			sock = INVALID_FD;
+	int			conn;
+	int			fd_stdout = INVALID_FD;
+	struct timeval		timeout;
+	bool			bound = false;
+	bool			ok;
+	bool			result = true;
+
+	memset(&stats, 0, sizeof(stats));
+	if (strlen(cmdl->ServePath) >= sizeof(addr.sun_path)) {
+		fprintf(fpError, "%s: ERROR: Too long socket path. path=\"%s\"\n",
+			cmdl->Argv0, cmdl->ServePath
+		);
+		return false;
+	}
+	/* Client may go away, see EPIPE instead of being killed. */
+	signal(SIGPIPE, SIG_IGN);
+	/* No SA_RESTART, accept() returns at signal. */
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = PrandServerSignal;
+	sigemptyset(&(sa.sa_mask));
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, cmdl->ServePath);
+	if ((lstat(cmdl->ServePath, &st) == 0) && S_ISSOCK(st.st_mode)) {
+		/* Live server accepts connection, don't take its socket. */
+		sock = socket(AF_UNIX, SOCK_STREAM, 0);
+		if ((sock != INVALID_FD) &&
+		    (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0)) {
+			fprintf(fpError, "%s: ERROR: Socket is in use by another server. path=\"%s\"\n",
+				cmdl->Argv0, cmdl->ServePath
+			);
+			result = false;
+			goto out;
+		}
+		if (sock != INVALID_FD) {
+			close(sock);
+		}
+		/* Left by previous server. */
+		unlink(cmdl->ServePath);
+	}
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if ((sock != INVALID_FD) &&
+	    (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0)) {
+		/* Socket file is ours, remove it at exit. */
+		bound = true;
+	}
+	if ((!bound) || (listen(sock, 16) != 0)) {
+		fprintf(fpError, "%s: ERROR: Can not listen socket, %s. path=\"%s\"\n",
+			cmdl->Argv0, strerror(errno), cmdl->ServePath
+		);
+		result = false;
+		goto out;
+	}
+	fd_stdout = dup(STDOUT_FILENO);
+	if (fd_stdout == INVALID_FD) {
+		fprintf(fpError, "%s: ERROR: Can not duplicate stdout, %s.\n",
+			cmdl->Argv0, strerror(errno)
+		);
+		result = false;
+		goto out;
+	}
+
+	while (!PrandServerStop) {
+		conn = accept(sock, NULL, NULL);
+		if (conn == INVALID_FD) {
+			if (errno == EINTR) {
+				continue;
+			}
+			fprintf(fpError, "%s: ERROR: Can not accept connection, %s.\n",
+				cmdl->Argv0, strerror(errno)
+			);
+			result = false;
+			break;
+		}
+		/* A stalled client can't hold server forever. */
+		timeout.tv_sec = PRAND_SERVER_TIMEOUT;
+		timeout.tv_usec = 0;
+		setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		setsockopt(conn, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		ok = PrandServerRequest(cmdl, conn, fd_stdout);
+		close(conn);
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+
+		latency = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+		if ((stats.Requests == 0) || (latency < stats.LatencyMin)) {
+			stats.LatencyMin = latency;
+		}
+		if (latency > stats.LatencyMax) {
+			stats.LatencyMax = latency;
+		}
+		stats.LatencySum += latency;
+		stats.Requests++;
+		if (!ok) {
+			stats.Errors++;
+		}
+		if (cmdl->Debug) {
+			fprintf(fpError, "%s: DEBUG: Request. n=%" PRIu64 ", result=%s, latency=%.3fms\n",
+				cmdl->Argv0, stats.Requests, (ok ? "ok" : "error"), latency * 1e3
+			);
+		}
+	}
+	fprintf(fpError, "%s: INFO: Server statistics. requests=%" PRIu64 ", errors=%" PRIu64
+		", latency_min=%.3fms, latency_avg=%.3fms, latency_max=%.3fms\n",
+		cmdl->Argv0, stats.Requests, stats.Errors,
+		stats.LatencyMin * 1e3,
+		(stats.Requests ? stats.LatencySum / stats.Requests : 0.0) * 1e3,
+		stats.LatencyMax * 1e3
+	);
+out:
+	if (fd_stdout != INVALID_FD) {
+		close(fd_stdout);
+	}
+	if (sock != INVALID_FD) {
+		close(sock);
+	}
+	if (bound) {
+		unlink(cmdl->ServePath);
+	}
+	return result;
+}
+
+int main(int argc, char **argv, __maybe_unused char **env)
+{	int	result = 0;
+	char	*a0;
+
+	fpError = stderr;
+
+	a0 = argv[0];
+	CommandLine = CCommandLineDefault;
+	if (!CCommandLineParse(&CommandLine, argc, argv) ||
+	    CommandLine.Help) {
+		PrandHelp(a0);
+		return 1;
+	}
+	if (CommandLine.Debug) {
+		fprintf(fpError, "%s: DEBUG: Debug mode. Seed=%ld, Engine=%s, Offset=%" PRIu64 ", Length=%ld\n",
+			a0,
+			(long)(CommandLine.Seed),
+			(CommandLine.Engine ? CommandLine.Engine->Name : "(unknown)"),
+			CommandLine.Offset,
+			(long)(CommandLine.Length)
+		);
+	}
+	if (CommandLine.ServePath) {
+		if (!PrandServe(&CommandLine)) {
+			result = 2;
+		}
+		return result;
+	}
+	if (CommandLine.Manifest) {
+		if (!PrandManifest(&CommandLine)) {
+			result = 2;
+		}
+		return result;
 	}
-	if (!EmitPesudoRand(&CommandLine)) {
+	if (!PrandEmit(&CommandLine)) {
 		result = 2;
 	}
 	return result;
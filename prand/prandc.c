@@ -0,0 +1,339 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* Client of prand server (prand -S socket_path). */
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#if (!defined(__maybe_unused))
+#if defined(__GNUC__)
+#define __maybe_unused __attribute__((unused))
+#else
+#define __maybe_unused
+#endif /* defined(__GNUC__) */
+#endif /* (!defined(__maybe_unused)) */
+
+#if (!defined(INVALID_FD))
+#define	INVALID_FD	(-1)
+#endif
+
+/* Error output file pointer.
+ */
+FILE	*fpError = NULL;
+
+const char HelpMessage[] =
+	"%s: HELP: Request pseudo random byte(s) to prand server, write them to stdout.\n"
+	"%s: HELP: prandc socket_path [prand options] bytes_to_output\n"
+	"%s: HELP: Options and output are the same as prand, see prand -h.\n"
+	"%s: HELP: Exits with 2 when server reports error or output is incomplete.\n"
+	;
+
+/*! Copy buffer size. */
+#define	PRANDC_BUFFER_SIZE	(1024 * 1024)
+
+/*! Write all bytes to fd, retry partial write and EINTR.
+ *  @return bool true: success, false: error.
+ */
+static bool WriteAll(int fd, const void *buf, size_t n)
+{	const uint8_t	*p = buf;
+	ssize_t		wlen;
+
+	while (n > 0) {
+		wlen = write(fd, p, n);
+		if (wlen < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		p += wlen;
+		n -= wlen;
+	}
+	return true;
+}
+
+/*! Connect to server.
+ *  @return int socket, INVALID_FD: error.
+ */
+int PrandcConnect(const char *a0, const char *path)
+{	struct sockaddr_un	addr;
+	int			sock;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		fprintf(fpError, "%s: ERROR: Too long socket path. path=\"%s\"\n",
+			a0, path
+		);
+		return INVALID_FD;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock == INVALID_FD) {
+		fprintf(fpError, "%s: ERROR: Can not create socket, %s.\n",
+			a0, strerror(errno)
+		);
+		return INVALID_FD;
+	}
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		fprintf(fpError, "%s: ERROR: Can not connect to server, %s. path=\"%s\"\n",
+			a0, strerror(errno), path
+		);
+		close(sock);
+		return INVALID_FD;
+	}
+	return sock;
+}
+
+/*! Send request, each argument followed by LF, and empty line.
+ *  @return bool true: success, false: error.
+ */
+bool PrandcRequest(const char *a0, int sock, int argc, char **argv)
+{	char	*req;
+	size_t	len = 1;
+	size_t	n;
+	char	*p;
+	int	i;
+	bool	result = true;
+
+	for (i = 0; i < argc; i++) {
+		if (strchr(argv[i], '\n') != NULL) {
+			fprintf(fpError, "%s: ERROR: Argument contains LF. arg=\"%s\"\n",
+				a0, argv[i]
+			);
+			return false;
+		}
+		len += strlen(argv[i]) + 1;
+	}
+	req = malloc(len);
+	if (!req) {
+		fprintf(fpError, "%s: ERROR: Can not allocate request. n=%ld\n",
+			a0, (long)len
+		);
+		return false;
+	}
+	p = req;
+	for (i = 0; i < argc; i++) {
+		n = strlen(argv[i]);
+		memcpy(p, argv[i], n);
+		p += n;
+		*p = '\n';
+		p++;
+	}
+	*p = '\n';
+	if (!WriteAll(sock, req, len)) {
+		fprintf(fpError, "%s: ERROR: Can not send request, %s.\n",
+			a0, strerror(errno)
+		);
+		result = false;
+	}
+	free(req);
+	return result;
+}
+
+/*! Reply reader, buffers bytes received. */
+typedef struct {
+	const char	*Argv0;
+	int		Sock;
+	uint8_t		*Buf;
+	size_t		Pos;	/*!< Next byte to take. */
+	size_t		Len;	/*!< Bytes in Buf. */
+} PrandcReader;
+
+/*! Receive more bytes, keep bytes not taken yet.
+ *  @return int 1: received, 0: closed, -1: error.
+ */
+static int PrandcReceive(PrandcReader *r)
+{	ssize_t	rlen;
+
+	memmove(r->Buf, r->Buf + r->Pos, r->Len - r->Pos);
+	r->Len -= r->Pos;
+	r->Pos = 0;
+	if (r->Len >= PRANDC_BUFFER_SIZE) {
+		fprintf(fpError, "%s: ERROR: Too long line in reply.\n", r->Argv0);
+		return -1;
+	}
+	while ((rlen = read(r->Sock, r->Buf + r->Len, PRANDC_BUFFER_SIZE - r->Len)) < 0) {
+		if (errno != EINTR) {
+			fprintf(fpError, "%s: ERROR: Can not receive reply, %s.\n",
+				r->Argv0, strerror(errno)
+			);
+			return -1;
+		}
+	}
+	r->Len += rlen;
+	return (rlen > 0);
+}
+
+/*! Take a line from reply, LF is replaced with NUL.
+ *  @return char * line, NULL: closed or error.
+ */
+static char *PrandcLine(PrandcReader *r)
+{	uint8_t	*lf;
+	char	*line;
+
+	while (!(lf = memchr(r->Buf + r->Pos, '\n', r->Len - r->Pos))) {
+		if (PrandcReceive(r) <= 0) {
+			return NULL;
+		}
+	}
+	*lf = 0;
+	line = (char *)(r->Buf + r->Pos);
+	r->Pos = lf + 1 - r->Buf;
+	return line;
+}
+
+/*! Copy bytes from reply to fd.
+ *  @param n bytes to copy, SIZE_MAX: until server closes connection.
+ *  @return bool true: success, false: error.
+ */
+static bool PrandcCopy(PrandcReader *r, int fd, size_t n)
+{	size_t	m;
+	int	rc;
+
+	while (n > 0) {
+		if (r->Pos >= r->Len) {
+			rc = PrandcReceive(r);
+			if (rc < 0) {
+				return false;
+			}
+			if (rc == 0) {
+				if (n == SIZE_MAX) {
+					return true;
+				}
+				fprintf(fpError, "%s: ERROR: Server closed connection in frame.\n",
+					r->Argv0
+				);
+				return false;
+			}
+		}
+		m = r->Len - r->Pos;
+		if (m > n) {
+			m = n;
+		}
+		if (!WriteAll(fd, r->Buf + r->Pos, m)) {
+			fprintf(fpError, "%s: ERROR: Can not write output, %s.\n",
+				r->Argv0, strerror(errno)
+			);
+			return false;
+		}
+		r->Pos += m;
+		if (n != SIZE_MAX) {
+			n -= m;
+		}
+	}
+	return true;
+}
+
+/*! Receive reply, copy output to stdout and messages to error output.
+ *  Output is in frames, length in hex and LF, then bytes. Empty frame
+ *  ends output, then status line of output and messages follow.
+ *  @return bool true: server returned OK at end, false: error.
+ */
+bool PrandcReply(const char *a0, int sock)
+{	PrandcReader	r;
+	char		*line;
+	char		*p;
+	unsigned long	len;
+	bool		ok;
+	bool		result = false;
+
+	memset(&r, 0, sizeof(r));
+	r.Argv0 = a0;
+	r.Sock = sock;
+	r.Buf = malloc(PRANDC_BUFFER_SIZE);
+	if (!(r.Buf)) {
+		fprintf(fpError, "%s: ERROR: Can not allocate buffer. n=%ld\n",
+			a0, (long)PRANDC_BUFFER_SIZE
+		);
+		return false;
+	}
+	/* Status line of request, "OK" or "ERROR". */
+	line = PrandcLine(&r);
+	if (!line) {
+		fprintf(fpError, "%s: ERROR: Server closed connection without reply.\n",
+			a0
+		);
+		goto out;
+	}
+	if (strcmp(line, "OK") != 0) {
+		PrandcCopy(&r, fileno(fpError), SIZE_MAX);
+		goto out;
+	}
+	while (true) {
+		line = PrandcLine(&r);
+		if (!line) {
+			fprintf(fpError, "%s: ERROR: Server closed connection before end of output.\n",
+				a0
+			);
+			goto out;
+		}
+		errno = 0;
+		len = strtoul(line, &p, 16);
+		if ((p == line) || (*p != 0) || (errno != 0)) {
+			fprintf(fpError, "%s: ERROR: Broken frame in reply. line=\"%s\"\n",
+				a0, line
+			);
+			goto out;
+		}
+		if (len == 0) {
+			break;
+		}
+		if (!PrandcCopy(&r, STDOUT_FILENO, len)) {
+			goto out;
+		}
+	}
+	/* Status line of output, "OK" or "ERROR". */
+	line = PrandcLine(&r);
+	if (!line) {
+		fprintf(fpError, "%s: ERROR: Server closed connection without status of output.\n",
+			a0
+		);
+		goto out;
+	}
+	ok = (strcmp(line, "OK") == 0);
+	if (PrandcCopy(&r, fileno(fpError), SIZE_MAX)) {
+		result = ok;
+	}
+out:
+	free(r.Buf);
+	return result;
+}
+
+int main(int argc, char **argv, __maybe_unused char **env)
+{	int	result = 0;
+	int	sock;
+	char	*a0;
+
+	fpError = stderr;
+
+	a0 = argv[0];
+	if ((argc < 3) || (strcmp(argv[1], "-h") == 0)) {
+		fprintf(fpError, HelpMessage,
+			a0,
+			a0,
+			a0,
+			a0
+		);
+		return 1;
+	}
+	signal(SIGPIPE, SIG_IGN);
+	sock = PrandcConnect(a0, argv[1]);
+	if (sock == INVALID_FD) {
+		return 2;
+	}
+	if ((!PrandcRequest(a0, sock, argc - 2, argv + 2)) ||
+	    (!PrandcReply(a0, sock))) {
+		result = 2;
+	}
+	close(sock);
+	return result;
+}